@@ -20,6 +20,7 @@ import {
     createResponseFilter,
     createWs,
     fromJsonAsync,
+    getWsProtocol,
     isJsonRpcMessage,
     isJsonRpcObject,
     isJsonRpcResponse,
@@ -54,6 +55,24 @@ import {
 } from './utils';
 
 
+// Encodes JSON in an ArrayBuffer to test the binary encodings
+const testEncoding = {
+    name: 'test',
+    encode(data: any): ArrayBuffer {
+        const json = toJson(data);
+        const bytes = new Uint8Array(json.length);
+        for (let i = 0; i < json.length; ++i) {
+            bytes[i] = json.charCodeAt(i);
+        }
+        return bytes.buffer;
+    },
+    decode(data: ArrayBuffer): any {
+        const json = String.fromCharCode(...Array.from(new Uint8Array(data)));
+        return fromJson(json);
+    }
+};
+
+
 describe('Client', () => {
     it('should have a static .create() method that creates a new Client', () => {
         expect(typeof Client.create).toBe('function');
@@ -2167,6 +2186,91 @@ describe('Client', () => {
                     done();
                 });
         });
+
+        it('should use the binary encoding to send requests', done => {
+            const rpc = Client.create({
+                url: host,
+                encoding: testEncoding
+            });
+
+            const method = 'test';
+            const params = {values: [1.5, 2.5]};
+
+            mockServer.on('connection', socket => {
+                // TODO: (socket as any) is due to https://github.com/thoov/mock-socket/issues/224,
+                // remove when fixed
+                (socket as any).on('message', (data: any) => {
+                    expect(data).toBeInstanceOf(ArrayBuffer);
+                    const json = testEncoding.decode(data);
+
+                    expect(json.id).toBeDefined();
+                    expect(json.method).toBe(method);
+                    expect(json.jsonrpc).toBe(JSON_RPC_VERSION);
+                    expect(json.params).toEqual(params);
+
+                    done();
+                });
+            });
+
+            rpc.request(method, params);
+        });
+
+        it('should use the binary encoding to unpack request responses', done => {
+            const rpc = Client.create({
+                url: host,
+                encoding: testEncoding
+            });
+
+            const result = {pong: true};
+
+            mockServer.on('connection', socket => {
+                // TODO: (socket as any) is due to https://github.com/thoov/mock-socket/issues/224,
+                // remove when fixed
+                (socket as any).on('message', (data: any) => {
+                    const request = testEncoding.decode(data);
+                    const response = toJsonRpcResponse(request, result);
+                    socket.send(testEncoding.encode(response));
+                });
+            });
+
+            rpc.request('ping')
+                .then(res => {
+                    expect(res).toEqual(result);
+                    done();
+                });
+        });
+
+        it('should receive JSON text notifications with a binary encoding', done => {
+            const rpc = Client.create({
+                url: host,
+                encoding: testEncoding
+            });
+
+            const notification = new Notification('test', {ping: true});
+
+            mockServer.on('connection', socket => {
+                socket.send(toJson(notification));
+            });
+
+            rpc.subscribe(n => {
+                expect(n).toEqual(notification);
+                done();
+            });
+        });
+    });
+});
+
+describe('getWsProtocol()', () => {
+    it('should return the protocol as is without a binary encoding', () => {
+        expect(getWsProtocol({url: 'myhost'})).toBeUndefined();
+        expect(getWsProtocol({url: 'myhost', protocol: 'myprotocol'})).toBe('myprotocol');
+    });
+
+    it('should append the name of the binary encoding to the protocol', () => {
+        const encoding = testEncoding;
+        expect(getWsProtocol({url: 'myhost', encoding})).toBe('rockets.test');
+        expect(getWsProtocol({url: 'myhost', encoding, protocol: 'myprotocol'})).toBe('myprotocol.test');
+        expect(getWsProtocol({url: 'myhost', encoding, protocol: ['a', 'b']})).toEqual(['a.test', 'b.test']);
     });
 });
 
@@ -37,6 +37,7 @@ import {
     PROGRESS,
     PROGRESS_EVENT,
     PROGRESS_EVENT_TYPE,
+    ROCKETS_PROTOCOL,
     SOCKET_CLOSED,
     SOCKET_PIPE_BROKEN,
     WS,
@@ -329,12 +330,24 @@ export class Client implements Subscribable<Notification> {
 
 
 export interface ClientOptions extends Pick<WebSocketSubjectConfig<any>, 'url' | 'protocol'> {
+    encoding?: BinaryEncoding;
     onConnected?(): void;
     onClosed?(evt: CloseEvent): void;
     deserializer?(evt: MessageEvent): Promise<JsonRpcNotification | JsonRpcResponse>;
     serializer?(data: Notification | Request): ArrayBuffer | string;
 }
 
+/**
+ * A binary encoding of the messages, e.g. MessagePack or CBOR.
+ * The client connects with the `<protocol>.<name>` websocket protocol,
+ * which selects the same encoding for the responses of the server.
+ */
+export interface BinaryEncoding {
+    name: string;
+    encode(data: any): ArrayBuffer | ArrayBufferView;
+    decode(data: ArrayBuffer): any;
+}
+
 export interface RequestTask<P, R> extends PromiseLike<R> {
     request: Request<P>;
     on(event: TaskEvent): Observable<Progress>;
@@ -361,7 +374,8 @@ export function createWs(config: ClientOptions): WebSocketSubject<any> {
 
     return webSocket({
         url,
-        protocol: config.protocol,
+        protocol: getWsProtocol(config),
+        binaryType: config.encoding ? 'arraybuffer' : undefined,
         // Override rxjs' default mechanism to JSON.stringify()
         serializer: (message: any) => message,
         // Override rxjs' default mechanism to JSON.parse().
@@ -403,6 +417,22 @@ export function setWsProtocol(url: string): string {
     return `${WS}${segment}${url}`;
 }
 
+/**
+ * @param config
+ * @private
+ */
+export function getWsProtocol(config: ClientOptions): string | string[] | undefined {
+    const {encoding, protocol} = config;
+    if (!encoding) {
+        return protocol;
+    }
+    const withEncoding = (name: string) => `${name}.${encoding.name}`;
+    if (Array.isArray(protocol)) {
+        return protocol.map(withEncoding);
+    }
+    return withEncoding(protocol || ROCKETS_PROTOCOL);
+}
+
 /**
  * @param id
  * @private
@@ -458,22 +488,53 @@ export async function fromJsonAsync<T>(evt: MessageEvent): Promise<T | undefined
     }
 }
 
+/**
+ * @param encoding
+ * @private
+ */
+export function createBinaryDeserializer(encoding: BinaryEncoding) {
+    return async <T>(evt: MessageEvent): Promise<T | undefined> => {
+        // Server notifications are always sent as JSON text
+        if (isString(evt.data)) {
+            return fromJsonAsync<T>(evt);
+        }
+        try {
+            return encoding.decode(evt.data) as T;
+        } catch {
+            return;
+        }
+    };
+}
+
 function getSerializer(config: ClientOptions) {
-    const {serializer} = config;
+    const {encoding, serializer} = config;
     if (isFunction(serializer)) {
         return serializer;
     }
+    if (encoding) {
+        return (data: any) => encoding.encode(toPlainObject(data));
+    }
     return toJson;
 }
 
 function getDeserializer(config: ClientOptions) {
-    const {deserializer} = config;
+    const {deserializer, encoding} = config;
     if (isFunction(deserializer)) {
         return deserializer;
     }
+    if (encoding) {
+        return createBinaryDeserializer(encoding);
+    }
     return fromJsonAsync;
 }
 
+function toPlainObject(data: any): any {
+    if (Array.isArray(data)) {
+        return data.map(toPlainObject);
+    }
+    return isObject(data) && isFunction((data as any).toJSON) ? (data as any).toJSON() : data;
+}
+
 function toJson(data: any) {
     return JSON.stringify(data);
 }
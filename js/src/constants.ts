@@ -39,3 +39,6 @@ export type ProtocolType = typeof HTTP
     | typeof HTTPS
     | typeof WS
     | typeof WSS;
+
+// Default websocket protocol of a Rockets server
+export const ROCKETS_PROTOCOL = 'rockets';
@@ -21,6 +21,7 @@ export {Response} from './response';
 export {
     BatchResponse,
     BatchTask,
+    BinaryEncoding,
     Client,
     ClientOptions,
     RequestTask,
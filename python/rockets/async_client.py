@@ -28,7 +28,7 @@ import sys
 
 from functools import reduce
 import websockets
-from jsonrpc.jsonrpc2 import JSONRPC20Request
+from jsonrpc.jsonrpc2 import JSONRPC20BatchRequest, JSONRPC20Request
 from rx import Observable
 
 from .notification import Notification
@@ -37,29 +37,40 @@ from .request_error import INVALID_REQUEST, SOCKET_CLOSED_ERROR, RequestError
 from .request_progress import RequestProgress
 from .request_task import RequestTask
 from .response import Response
-from .utils import is_json_rpc_notification, is_json_rpc_response, is_progress_notification, \
-                   set_ws_protocol
+from .utils import JSON, get_binary_codec, is_json_rpc_notification, is_json_rpc_response, \
+                   is_progress_notification, set_ws_protocol
 
 
 class AsyncClient:
     """Asynchronous client implementation for asyncio event loop processing of JSON-RPC messages."""
 
-    def __init__(self, url, subprotocols=None, loop=None):
+    def __init__(self, url, subprotocols=None, loop=None, encoding=JSON):
         """
         Initialize the state of the client.
 
         Convert the URL to a proper format. Does not establish the websocket connection yet. This
         will be postponed to the first notify or request.
 
+        The binary encodings send the requests and notifications in binary messages, and select
+        the same encoding for the responses by connecting with the '<subprotocol>.<encoding>'
+        websocket protocols. They require the msgpack or cbor2 package respectively.
+
         :param str url: The address of the Rockets server.
         :param list subprotocols: The websocket protocols to use
         :param asyncio.AbstractEventLoop loop: Event loop where this client should run in
+        :param str encoding: The encoding of the messages: 'json', 'msgpack' or 'cbor'
         """
         self.url = set_ws_protocol(url)
         """The address of the connected Rockets server."""
 
         if not subprotocols:
             subprotocols = ['rockets']
+
+        self._encode_binary = None
+        self._decode_binary = None
+        if encoding != JSON:
+            self._encode_binary, self._decode_binary = get_binary_codec(encoding)
+            subprotocols = [protocol + '.' + encoding for protocol in subprotocols]
         self._subprotocols = subprotocols
 
         self._ws = None
@@ -78,15 +89,16 @@ class AsyncClient:
         """The websocket stream as an rx observable to subscribe to it."""
         # pylint: enable=E1101
 
-        def _json_filter(value):
+        def _decode(value):
             try:
-                json.loads(value)
-                return True
+                if self._decode_binary and isinstance(value, bytes):
+                    return self._decode_binary(value)
+                return json.loads(value)
             except ValueError:  # pragma: no cover
-                return False
+                return None
 
-        # filter everything that is not JSON
-        self._json_stream = self.ws_observable.filter(_json_filter).map(json.loads)
+        # filter everything that is not JSON, or in the binary encoding
+        self._json_stream = self.ws_observable.map(_decode).filter(lambda x: x is not None)
 
         def _notifications_filter(value):
             return is_json_rpc_notification(value) and not is_progress_notification(value)
@@ -136,7 +148,7 @@ class AsyncClient:
         :param str params: params for the method
         """
         notification = Notification(method, params)
-        await self.send(notification.json)
+        await self.send(self._serialize(notification))
 
     async def request(self, method, params=None):
         """
@@ -158,7 +170,7 @@ class AsyncClient:
             self._setup_response_filter(response_future, request_id)
             self._setup_progress_filter(response_future, request_id)
 
-            await self.send(request.json)
+            await self.send(self._serialize(request))
             await response_future
             return response_future.result()
         except asyncio.CancelledError:
@@ -198,7 +210,7 @@ class AsyncClient:
             self._setup_batch_response_filter(response_future, request_ids)
             self._setup_batch_progress_filter(response_future, request_ids)
 
-            await self.send(request.json)
+            await self.send(self._serialize(request))
             await response_future
             return response_future.result()
         except asyncio.CancelledError:
@@ -232,6 +244,14 @@ class AsyncClient:
         task = self.batch(requests)
         return asyncio.ensure_future(task, loop=self.loop)
 
+    def _serialize(self, request):
+        """Internal: The message of a request or notification in the encoding of the client."""
+        if not self._encode_binary:
+            return request.json
+        if isinstance(request, JSONRPC20BatchRequest):
+            return self._encode_binary([item.data for item in request.requests])
+        return self._encode_binary(request.data)
+
     async def _ws_loop(self, observer):
         """Internal: The loop for feeding an rxpy observer."""
         try:
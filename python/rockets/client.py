@@ -26,13 +26,13 @@ import asyncio
 
 from threading import Thread
 from .async_client import AsyncClient
-from .utils import copydoc
+from .utils import JSON, copydoc
 
 
 class Client:
     """Client that support synchronous usage of the :class:`AsyncClient`."""
 
-    def __init__(self, url, subprotocols=None, loop=None):
+    def __init__(self, url, subprotocols=None, loop=None, encoding=JSON):
         """
         Setup the :class:`AsyncClient` for synchronous usage.
 
@@ -41,6 +41,7 @@ class Client:
         :param str url: The address of the Rockets server.
         :param list subprotocols: The websocket protocols to use
         :param asyncio.AbstractEventLoop loop: Event loop where this client should run in
+        :param str encoding: The encoding of the messages: 'json', 'msgpack' or 'cbor'
         """
         if not loop:
             loop = asyncio.get_event_loop()
@@ -56,10 +57,12 @@ class Client:
             self._thread.daemon = True
             self._thread.start()
 
-            self._client = AsyncClient(url, subprotocols=subprotocols, loop=thread_loop)
+            self._client = AsyncClient(url, subprotocols=subprotocols, loop=thread_loop,
+                                       encoding=encoding)
         else:
             self._thread = None
-            self._client = AsyncClient(url, subprotocols=subprotocols, loop=loop)
+            self._client = AsyncClient(url, subprotocols=subprotocols, loop=loop,
+                                       encoding=encoding)
 
         self.url = self._client.url
         """The address of the connected Rockets server."""
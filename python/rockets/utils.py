@@ -30,6 +30,10 @@ HTTPS = 'https://'
 WS = 'ws://'
 WSS = 'wss://'
 
+JSON = 'json'
+MSGPACK = 'msgpack'
+CBOR = 'cbor'
+
 
 def set_ws_protocol(url):
     """
@@ -48,6 +52,27 @@ def set_ws_protocol(url):
     return WS + url
 
 
+def get_binary_codec(encoding):
+    """
+    Get the functions to encode and decode messages in a binary encoding.
+
+    The codecs come from the optional msgpack and cbor2 packages, imported on first use.
+
+    :param str encoding: 'msgpack' or 'cbor'
+    :return: the encode and decode functions
+    :rtype: tuple
+    :raises ValueError: if the encoding is not supported
+    """
+    if encoding == MSGPACK:
+        import msgpack
+        return (lambda data: msgpack.packb(data, use_bin_type=True),
+                lambda message: msgpack.unpackb(message, raw=False))
+    if encoding == CBOR:
+        import cbor2
+        return cbor2.dumps, cbor2.loads
+    raise ValueError('Unsupported encoding: ' + str(encoding))
+
+
 def copydoc(fromfunc, sep="\n"):
     """
     Decorator: Copy the docstring of `fromfunc`
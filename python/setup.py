@@ -54,6 +54,10 @@ with open(os.path.join(this_directory, 'README.md')) as f:
 setup(
     packages=['rockets'],
     install_requires=REQS,
+    extras_require={
+        'msgpack': ['msgpack>=0.5.6'],
+        'cbor': ['cbor2>=4.1.2']
+    },
     long_description=long_description,
     long_description_content_type='text/markdown'
 )
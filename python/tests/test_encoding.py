@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# Copyright (c) 2018, Blue Brain Project
+#                     Daniel Nachbaur <daniel.nachbaur@epfl.ch>
+#
+# This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+#
+# This library is free software; you can redistribute it and/or modify it under
+# the terms of the GNU Lesser General Public License version 3.0 as published
+# by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+# details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this library; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+# All rights reserved. Do not distribute without further notice.
+
+import asyncio
+import json
+import websockets
+from jsonrpcserver.aio import methods
+
+import cbor2
+import msgpack
+from nose.tools import assert_equal, raises
+import rockets
+
+
+@methods.add
+async def double(value):
+    return value*2
+
+CODECS = {
+    'rockets.msgpack': (lambda data: msgpack.packb(data, use_bin_type=True),
+                        lambda message: msgpack.unpackb(message, raw=False)),
+    'rockets.cbor': (cbor2.dumps, cbor2.loads)
+}
+
+async def server_handle(websocket, path):
+    encode, decode = CODECS[websocket.subprotocol]
+    request = await websocket.recv()
+    # the binary encoding is selected by the websocket protocol of the client
+    assert isinstance(request, bytes)
+
+    response = await methods.dispatch(json.dumps(decode(request)))
+    if not response.is_notification:
+        await websocket.send(encode(json.loads(str(response))))
+
+server_url = None
+def setup():
+    start_server = websockets.serve(server_handle, 'localhost',
+                                    subprotocols=list(CODECS.keys()))
+    server = asyncio.get_event_loop().run_until_complete(start_server)
+    global server_url
+    server_url = 'localhost:'+str(server.sockets[0].getsockname()[1])
+
+
+def test_msgpack_request():
+    client = rockets.Client(server_url, encoding='msgpack')
+    assert_equal(client.request('double', [2.5]), 5.0)
+
+
+def test_cbor_request():
+    client = rockets.Client(server_url, encoding='cbor')
+    assert_equal(client.request('double', [2.5]), 5.0)
+
+
+def test_msgpack_batch():
+    client = rockets.Client(server_url, encoding='msgpack')
+    request_1 = rockets.Request('double', [2])
+    request_2 = rockets.Request('double', [4])
+    responses = client.batch([request_1, request_2])
+    assert_equal(sorted(response.result for response in responses), [4, 8])
+
+
+@raises(ValueError)
+def test_unsupported_encoding():
+    rockets.Client(server_url, encoding='xml')
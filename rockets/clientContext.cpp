@@ -87,6 +87,7 @@ ClientContext::ClientContext(lws_callback_function* callback, void* user)
     memset(&info, 0, sizeof(info));
     info.port = CONTEXT_PORT_NO_LISTEN;
     info.protocols = protocols.data();
+    info.extensions = websocket_extensions();
     info.gid = -1;
     info.uid = -1;
     info.max_http_header_data = 4096;
@@ -0,0 +1,51 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_BODYSINK_H
+#define ROCKETS_HTTP_BODYSINK_H
+
+#include <rockets/api.h>
+#include <rockets/http/types.h>
+
+namespace rockets
+{
+namespace http
+{
+/**
+ * Receiver of the payload of a request, as it arrives.
+ *
+ * A sink is created for each request to an endpoint registered with
+ * Server::handleStream(); the payload is then not accumulated in Request::body.
+ * All methods are called from the thread serving the connection.
+ */
+class BodySink
+{
+public:
+    ROCKETS_API virtual ~BodySink() = default;
+
+    /** Receive the next part of the payload. */
+    ROCKETS_API virtual void onData(const char* data, size_t size) = 0;
+
+    /** @return the response to the request, once all data was received. */
+    ROCKETS_API virtual std::future<Response> onComplete(
+        const Request& request) = 0;
+};
+}
+}
+#endif
@@ -22,6 +22,9 @@
 #include "response.h"
 #include "utils.h"
 
+#include <cstdio>
+#include <cstring>
+
 namespace rockets
 {
 namespace http
@@ -31,7 +34,9 @@ namespace
 const int HEADERS_BUFFER_SIZE = 4096;
 const int MAX_HEADER_LENGTH = 512;
 const int MAX_QUERY_PARAM_LENGTH = 4096;
+const int MAX_CHUNK_HEADER_LENGTH = 16;
 const std::string JSON_TYPE = "application/json";
+const std::string CHUNKED_ENCODING = "chunked";
 
 lws_token_indexes to_lws_token(const Header header)
 {
@@ -47,6 +52,12 @@ lws_token_indexes to_lws_token(const Header header)
         return WSI_TOKEN_HTTP_LOCATION;
     case Header::RETRY_AFTER:
         return WSI_TOKEN_HTTP_RETRY_AFTER;
+    case Header::ETAG:
+        return WSI_TOKEN_HTTP_ETAG;
+    case Header::CONTENT_ENCODING:
+        return WSI_TOKEN_HTTP_CONTENT_ENCODING;
+    case Header::VARY:
+        return WSI_TOKEN_HTTP_VARY;
     default:
         return WSI_TOKEN_COUNT; // should not happen
     }
@@ -113,6 +124,29 @@ std::map<std::string, std::string> Channel::readQueryParameters() const
     return query;
 }
 
+std::map<std::string, std::string> Channel::readRequestHeaders() const
+{
+    std::map<std::string, std::string> headers;
+    for (int i = 0; i < WSI_TOKEN_COUNT; ++i)
+    {
+        const auto token = static_cast<lws_token_indexes>(i);
+        if (lws_hdr_total_length(wsi, token) == 0)
+            continue;
+
+        // Only the "name:" tokens are headers, not the method, uri or args
+        const auto name = reinterpret_cast<const char*>(
+            lws_token_to_string(token));
+        const auto length = name ? std::strlen(name) : 0;
+        if (length < 2 || name[0] == ':' || name[length - 1] != ':')
+            continue;
+
+        auto value = _readHeader(token);
+        if (!value.empty())
+            headers.emplace(std::string(name, length - 1), std::move(value));
+    }
+    return headers;
+}
+
 CorsRequestHeaders Channel::readCorsRequestHeaders() const
 {
     CorsRequestHeaders cors;
@@ -145,8 +179,29 @@ int Channel::writeResponseHeaders(const CorsResponseHeaders& corsHeaders,
     if (lws_add_http_header_status(wsi, response.code, &p, end))
         return 1;
 
-    if (lws_add_http_header_content_length(wsi, response.body.size(), &p, end))
-        return 1;
+    if (!response.isStreamed())
+    {
+        if (lws_add_http_header_content_length(wsi, response.body.size(), &p,
+                                               end))
+        {
+            return 1;
+        }
+    }
+    else if (response.bodySize > 0)
+    {
+        if (lws_add_http_header_content_length(wsi, response.bodySize, &p, end))
+            return 1;
+    }
+    else
+    {
+        const auto value = (const unsigned char*)CHUNKED_ENCODING.c_str();
+        if (lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_TRANSFER_ENCODING,
+                                         value, CHUNKED_ENCODING.size(), &p,
+                                         end))
+        {
+            return 1;
+        }
+    }
 
     for (const auto& header : response.headers)
     {
@@ -177,7 +232,7 @@ int Channel::writeResponseHeaders(const CorsResponseHeaders& corsHeaders,
     if (n < 0)
         return -1;
 
-    if (!response.body.empty())
+    if (!response.body.empty() || response.isStreamed())
     {
         // Only one lws_write() allowed, book another callback for sending body
         requestCallback();
@@ -188,11 +243,39 @@ int Channel::writeResponseHeaders(const CorsResponseHeaders& corsHeaders,
     return lws_http_transaction_completed(wsi) ? -1 : 0;
 }
 
-int Channel::writeResponseBody(const Response& response)
+bool Channel::isSendPipeChoked() const
 {
-    if (!_write(response.body, LWS_WRITE_HTTP_FINAL))
+    return lws_send_pipe_choked(wsi);
+}
+
+const size_t Channel::bodyPartHeadroom = LWS_PRE + MAX_CHUNK_HEADER_LENGTH;
+const size_t Channel::bodyPartTailroom = 2;
+
+int Channel::writeResponseBodyPart(unsigned char* data, const size_t size,
+                                   const bool chunked, const bool last)
+{
+    auto start = data;
+    auto length = size;
+    if (chunked)
+    {
+        // <size in hex>\r\n<data>\r\n, the last chunk being empty
+        char header[MAX_CHUNK_HEADER_LENGTH];
+        const auto n = snprintf(header, sizeof(header), "%zx\r\n", size);
+        start -= n;
+        memcpy(start, header, n);
+        memcpy(data + size, "\r\n", 2);
+        length += n + 2;
+    }
+
+    const auto protocol = last ? LWS_WRITE_HTTP_FINAL : LWS_WRITE_HTTP;
+    if (lws_write(wsi, start, length, protocol) < 0)
         return -1;
 
+    if (!last)
+    {
+        requestCallback();
+        return 0;
+    }
     // Close and free connection if complete, else keep open
     return lws_http_transaction_completed(wsi) ? -1 : 0;
 }
@@ -219,7 +302,8 @@ Response::Headers Channel::readResponseHeaders() const
     Response::Headers headers;
     for (auto header :
          {Header::ALLOW, Header::CONTENT_TYPE, Header::LAST_MODIFIED,
-          Header::LOCATION, Header::RETRY_AFTER})
+          Header::LOCATION, Header::RETRY_AFTER, Header::ETAG,
+          Header::CONTENT_ENCODING, Header::VARY})
     {
         auto value = _readHeader(to_lws_token(header));
         if (!value.empty())
@@ -228,15 +312,26 @@ Response::Headers Channel::readResponseHeaders() const
     return headers;
 }
 
-int Channel::writeRequestHeader(const std::string& body, unsigned char** buffer,
-                                const size_t bufferSize)
+int Channel::writeRequestHeader(
+    const std::string& body, const std::map<std::string, std::string>& headers,
+    unsigned char** buffer, const size_t bufferSize)
 {
+    const auto end = *buffer + bufferSize - 1;
+    for (const auto& header : headers)
+    {
+        const auto name = header.first + ":";
+        if (lws_add_http_header_by_name(wsi, (unsigned char*)name.c_str(),
+                                        (unsigned char*)header.second.c_str(),
+                                        header.second.size(), buffer, end))
+        {
+            return -1;
+        }
+    }
+
 #if LWS_LIBRARY_VERSION_NUMBER >= 2001000
     if (body.empty())
         return 0;
 
-    const auto end = *buffer + bufferSize - 1;
-
     const auto length = std::to_string(body.size());
     const auto data = (unsigned char*)length.c_str();
     if (lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_LENGTH, data,
@@ -257,8 +352,6 @@ int Channel::writeRequestHeader(const std::string& body, unsigned char** buffer,
 #else
 #define UNUSED(expr) (void)(expr)
     UNUSED(body);
-    UNUSED(buffer);
-    UNUSED(bufferSize);
 #endif
     return 0;
 }
@@ -50,15 +50,35 @@ public:
     Method readMethod() const;
     std::string readOrigin() const;
     std::map<std::string, std::string> readQueryParameters() const;
+    std::map<std::string, std::string> readRequestHeaders() const;
     CorsRequestHeaders readCorsRequestHeaders() const;
     void requestCallback();
     int writeResponseHeaders(const CorsResponseHeaders& corsHeaders,
                              const Response& response);
-    int writeResponseBody(const Response& response);
+    bool isSendPipeChoked() const;
+
+    /** Space required before the data of writeResponseBodyPart(). */
+    static const size_t bodyPartHeadroom;
+    /** Space required after the data of writeResponseBodyPart(). */
+    static const size_t bodyPartTailroom;
+
+    /**
+     * Write a part of the response body, in place.
+     *
+     * @param data the part to write, surrounded by the writable head- and
+     *        tailroom needed for the lws and chunked transfer framing.
+     * @param size the size of the part, may be 0 for the last one.
+     * @param chunked use chunked transfer encoding.
+     * @param last the part is the last one of the body.
+     * @return 0 to keep the connection open, -1 to close it.
+     */
+    int writeResponseBodyPart(unsigned char* data, size_t size, bool chunked,
+                              bool last);
 
     /* Client */
-    int writeRequestHeader(const std::string& body, unsigned char** buffer,
-                           size_t bufferSize);
+    int writeRequestHeader(const std::string& body,
+                           const std::map<std::string, std::string>& headers,
+                           unsigned char** buffer, size_t bufferSize);
 #if LWS_LIBRARY_VERSION_NUMBER >= 2001000
     int writeRequestBody(const std::string& body);
     Code readResponseCode() const;
@@ -66,7 +66,8 @@ public:
 
     void startRequest(const Method method, const std::string& uri,
                       std::string body, std::function<void(Response)> callback,
-                      std::function<void(std::string)> errorCallback)
+                      std::function<void(std::string)> errorCallback,
+                      std::map<std::string, std::string> headers = {})
     {
 #if LWS_LIBRARY_VERSION_NUMBER < 2001000
         if (!body.empty())
@@ -76,7 +77,8 @@ public:
         {
             requests.emplace(lws, RequestHandler{Channel{lws}, std::move(body),
                                                  std::move(callback),
-                                                 std::move(errorCallback)});
+                                                 std::move(errorCallback),
+                                                 std::move(headers)});
         }
         else if (errorCallback)
             errorCallback(connectionFailure);
@@ -130,6 +132,14 @@ Client::~Client()
 
 std::future<Response> Client::request(const std::string& uri,
                                       const Method method, std::string body)
+{
+    return request(uri, method, std::move(body),
+                   std::map<std::string, std::string>());
+}
+
+std::future<Response> Client::request(
+    const std::string& uri, const Method method, std::string body,
+    std::map<std::string, std::string> headers)
 {
     auto promise = std::make_shared<std::promise<Response>>();
     auto callback = [promise](Response response) {
@@ -139,7 +149,7 @@ std::future<Response> Client::request(const std::string& uri,
         promise->set_exception(std::make_exception_ptr(std::runtime_error(e)));
     };
     _impl->startRequest(method, uri, std::move(body), std::move(callback),
-                        std::move(errorCallback));
+                        std::move(errorCallback), std::move(headers));
     return promise->get_future();
 }
 
@@ -60,6 +60,22 @@ public:
         const std::string& uri, http::Method method = http::Method::GET,
         std::string body = std::string());
 
+    /**
+     * Make an http request with additional headers.
+     *
+     * @param uri to address the request.
+     * @param method http method to use.
+     * @param body payload to send, may be empty.
+     * @param headers to send, by name, e.g. {{"Accept-Encoding", "gzip"}}.
+     * @throw std::invalid_argument if the uri is too long (>4000 char) or
+     *        some parameter is invalid or not supported.
+     * @return future http response - can be a std::runtime_error if the
+     *         request fails.
+     */
+    ROCKETS_API std::future<http::Response> request(
+        const std::string& uri, http::Method method, std::string body,
+        std::map<std::string, std::string> headers);
+
     /**
      * Make an http request.
      *
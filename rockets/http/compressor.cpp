@@ -0,0 +1,243 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "compressor.h"
+
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#ifdef ROCKETS_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace rockets
+{
+namespace http
+{
+namespace
+{
+const std::string ACCEPT_ENCODING = "accept-encoding";
+const std::string ACCEPT_ENCODING_HEADER = "Accept-Encoding";
+const std::string DEFLATE = "deflate";
+const std::string GZIP = "gzip";
+
+// zlib window sizes selecting the gzip or zlib (HTTP "deflate") format
+const int GZIP_WINDOW_BITS = 15 + 16;
+const int DEFLATE_WINDOW_BITS = 15;
+
+std::string _trim(const std::string& str)
+{
+    const auto begin = str.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return std::string();
+    const auto end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+/** @return the quality value of a coding, -1 if not listed. */
+float _getQuality(const std::string& acceptEncoding, const std::string& coding)
+{
+    float quality = -1.f;
+    std::istringstream list{acceptEncoding};
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        const auto separator = item.find(';');
+        const auto name = _trim(item.substr(0, separator));
+        if (name != coding && !(name == "*" && quality < 0.f))
+            continue;
+
+        float value = 1.f;
+        if (separator != std::string::npos)
+        {
+            const auto param = _trim(item.substr(separator + 1));
+            if (param.compare(0, 2, "q=") == 0)
+                value = std::strtof(param.c_str() + 2, nullptr);
+        }
+        if (name == coding)
+            return value;
+        quality = value; // wildcard, unless the coding is listed later
+    }
+    return quality;
+}
+
+bool _canCompress(const Response& response, const size_t minSize)
+{
+    return !response.isStreamed() && response.body.size() >= minSize &&
+           response.code != Code::PARTIAL_CONTENT &&
+           response.headers.count(Header::CONTENT_ENCODING) == 0;
+}
+
+#ifdef ROCKETS_USE_ZLIB
+std::string _deflate(const std::string& data, const std::string& encoding,
+                     const int level)
+{
+    z_stream stream{};
+    const auto windowBits =
+        encoding == GZIP ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return std::string();
+    }
+
+    // the bound is for the zlib format, plus the larger gzip header & trailer
+    std::string output(deflateBound(&stream, data.size()) + 12, '\0');
+    stream.next_in = (Bytef*)data.data();
+    stream.avail_in = (uInt)data.size();
+    stream.next_out = (Bytef*)&output[0];
+    stream.avail_out = (uInt)output.size();
+    const bool done = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return done ? output : std::string();
+}
+#endif
+} // anonymous namespace
+
+class Compressor::Impl
+{
+public:
+    using Body = std::shared_ptr<const std::string>;
+
+    explicit Impl(const CompressionOptions& options_)
+        : options(options_)
+    {
+    }
+
+    Body compress(const Response& response, const std::string& encoding,
+                  const std::string& path)
+    {
+        const auto etag = response.headers.find(Header::ETAG);
+        if (etag == response.headers.end() || options.cacheSize == 0)
+            return _compress(response.body, encoding);
+
+        // ETags cannot contain spaces, unlike paths
+        const auto key = encoding + ' ' + etag->second + ' ' + path;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            const auto it = cache.find(key);
+            if (it != cache.end())
+                return it->second;
+        }
+
+        // Concurrent requests may compress the same content more than once,
+        // but never wait for each other.
+        auto body = _compress(response.body, encoding);
+        std::lock_guard<std::mutex> lock{mutex};
+        if (cache.emplace(key, body).second)
+        {
+            keys.push_back(key);
+            if (keys.size() > options.cacheSize)
+            {
+                cache.erase(keys.front());
+                keys.pop_front();
+            }
+        }
+        return body;
+    }
+
+    const CompressionOptions options;
+
+private:
+    std::mutex mutex;
+    std::map<std::string, Body> cache;
+    std::deque<std::string> keys; // in insertion order, for eviction
+
+    Body _compress(const std::string& data, const std::string& encoding) const
+    {
+#ifdef ROCKETS_USE_ZLIB
+        auto output = _deflate(data, encoding, options.level);
+        // not worth it, e.g. for content which is already compressed
+        if (output.empty() || output.size() >= data.size())
+            return nullptr;
+        return std::make_shared<const std::string>(std::move(output));
+#else
+        (void)data;
+        (void)encoding;
+        return nullptr;
+#endif
+    }
+};
+
+bool Compressor::isSupported()
+{
+#ifdef ROCKETS_USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+Compressor::Compressor(const CompressionOptions& options)
+    : _impl{new Impl(options)}
+{
+}
+
+Compressor::~Compressor() = default;
+
+std::string Compressor::negotiate(const Request& request) const
+{
+    if (!isSupported() || _impl->options.level <= 0)
+        return std::string();
+
+    const auto header = request.headers.find(ACCEPT_ENCODING);
+    if (header == request.headers.end())
+        return std::string();
+
+    // prefer gzip, which is more widely supported than deflate
+    const auto gzip = _getQuality(header->second, GZIP);
+    const auto deflate = _getQuality(header->second, DEFLATE);
+    if (gzip <= 0.f && deflate <= 0.f)
+        return std::string();
+    return gzip >= deflate ? GZIP : DEFLATE;
+}
+
+bool Compressor::canCompress(const Response& response,
+                             const std::string& encoding) const
+{
+    return !encoding.empty() && _canCompress(response, _impl->options.minSize);
+}
+
+void Compressor::compress(Response& response, const std::string& encoding,
+                          const std::string& path) const
+{
+    if (!_canCompress(response, _impl->options.minSize))
+        return;
+
+    // caches must not serve a compressed response to other clients
+    response.headers[Header::VARY] = ACCEPT_ENCODING_HEADER;
+    if (encoding.empty())
+        return;
+
+    const auto body = _impl->compress(response, encoding, path);
+    if (!body)
+        return;
+
+    response.body = *body;
+    response.headers[Header::CONTENT_ENCODING] = encoding;
+    auto etag = response.headers.find(Header::ETAG);
+    if (etag != response.headers.end() && etag->second.compare(0, 2, "W/"))
+        etag->second = "W/" + etag->second;
+}
+}
+}
@@ -0,0 +1,87 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_COMPRESSOR_H
+#define ROCKETS_HTTP_COMPRESSOR_H
+
+#include <rockets/api.h>
+#include <rockets/http/request.h>
+#include <rockets/http/response.h>
+
+#include <memory>
+
+namespace rockets
+{
+namespace http
+{
+/**
+ * Compressor of the payload of responses, see Server::setCompression().
+ *
+ * The content coding (gzip or deflate) is negotiated from the Accept-Encoding
+ * header of the request. The compressed payload of responses with an ETag is
+ * cached by request path and ETag, so repeated requests for the same content
+ * are not compressed again.
+ * The ETag of compressed responses becomes a weak validator.
+ *
+ * Responses can be compressed from several threads concurrently.
+ */
+class Compressor
+{
+public:
+    /** @return false if Rockets was built without compression support. */
+    ROCKETS_API static bool isSupported();
+
+    ROCKETS_API explicit Compressor(const CompressionOptions& options);
+    ROCKETS_API ~Compressor();
+
+    /**
+     * @return the content coding accepted by the client for the response,
+     *         empty for sending it uncompressed.
+     */
+    ROCKETS_API std::string negotiate(const Request& request) const;
+
+    /**
+     * @return true if compress() may compress the payload of a response with
+     *         the given content coding, which is worth doing off the service
+     *         threads.
+     */
+    ROCKETS_API bool canCompress(const Response& response,
+                                 const std::string& encoding) const;
+
+    /**
+     * Compress the payload of a response if it is large enough.
+     *
+     * Streamed and partial payloads are never compressed.
+     *
+     * @param response to compress in place.
+     * @param encoding content coding returned by negotiate().
+     * @param path of the request, which identifies the resource since ETags
+     *        are only unique per resource.
+     */
+    ROCKETS_API void compress(Response& response, const std::string& encoding,
+                              const std::string& path) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+}
+
+#endif
@@ -20,10 +20,20 @@
 #include "connection.h"
 
 #include "../helpers.h"
+#include "../utils.h"
+#include "reply.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace
 {
+const size_t MAX_BODY_PART_SIZE = 65536;
+
+// The Content-Length comes from the client, don't trust it for allocating
+const size_t MAX_BODY_RESERVE_SIZE = 1048576;
+
 const std::logic_error response_already_set_error{"response was already set!"};
 const std::logic_error headers_already_sent_error{
     "response headers were already sent!"};
@@ -41,12 +51,24 @@ namespace http
 Connection::Connection(lws* wsi, const char* path)
     : channel{wsi}
     , request{channel.readMethod(), path, channel.readOrigin(),
-              channel.readQueryParameters(), ""}
+              channel.readQueryParameters(), "", "", {},
+              channel.readRequestHeaders()}
     , contentLength{channel.readContentLength()}
     , corsHeaders(channel.readCorsRequestHeaders())
     , corsResponseHeaders(_getCorsResponseHeaders())
 {
-    request.body.reserve(contentLength);
+    request.body.reserve(std::min(contentLength, MAX_BODY_RESERVE_SIZE));
+}
+
+Connection::~Connection()
+{
+    if (responder)
+        responder->detach();
+    if (bodyFile)
+    {
+        bodyFile.reset();
+        std::remove(request.bodyFile.c_str());
+    }
 }
 
 std::string Connection::getPathWithoutLeadingSlash() const
@@ -65,9 +87,65 @@ bool Connection::canHaveHttpBody() const
     return _canHaveHttpBody(getMethod()) && contentLength > 0;
 }
 
-void Connection::appendBody(const char* in, const size_t len)
+void Connection::setBodyOptions(const BodyOptions& options)
+{
+    bodyOptions = options;
+    if (bodyOptions.maxSize > 0 || bodyOptions.spillSize > 0)
+        request.body.shrink_to_fit();
+}
+
+void Connection::setBodySink(std::unique_ptr<BodySink> sink)
+{
+    bodySink = std::move(sink);
+    request.body.shrink_to_fit();
+}
+
+void Connection::discardBody()
+{
+    bodyDiscarded = true;
+    request.body.shrink_to_fit();
+}
+
+bool Connection::exceedsMaxBodySize() const
+{
+    return bodyOptions.maxSize > 0 &&
+           std::max(contentLength, bodySize) > bodyOptions.maxSize;
+}
+
+bool Connection::appendBody(const char* in, const size_t len)
 {
+    if (requestRejected)
+        return false;
+
+    bodySize += len;
+    if (exceedsMaxBodySize())
+        return false;
+
+    if (bodyDiscarded)
+        return true;
+
+    if (bodySink)
+    {
+        bodySink->onData(in, len);
+        return true;
+    }
+
+    if (!bodyFile && bodyOptions.spillSize > 0 &&
+        bodySize > bodyOptions.spillSize && !_spillBodyToFile())
+    {
+        return false;
+    }
+
+    if (bodyFile)
+        return std::fwrite(in, 1, len, bodyFile.get()) == len;
+
     request.body.append(in, len);
+    return true;
+}
+
+bool Connection::endBody()
+{
+    return !bodyFile || std::fflush(bodyFile.get()) == 0;
 }
 
 bool Connection::isCorsPreflightRequest() const
@@ -75,18 +153,50 @@ bool Connection::isCorsPreflightRequest() const
     return getMethod() == Method::OPTIONS && _hasCorsPreflightHeaders();
 }
 
-void Connection::overwriteRequestPath(std::string path)
+void Connection::overwriteRequestPath(
+    std::string path, std::map<std::string, std::string> pathParams)
 {
     request.path = std::move(path);
+    request.pathParams = std::move(pathParams);
 }
 
-void Connection::setResponse(std::future<Response>&& futureResponse)
+void Connection::setResponseEncoder(ResponderState::Encode encode,
+                                    ResponderState::Offload offload)
 {
     if (isResponseSet())
         throw response_already_set_error;
 
-    delayedResponse = std::move(futureResponse);
-    delayedResponseSet = true;
+    responseEncoder = std::move(encode);
+    responseOffload = std::move(offload);
+}
+
+void Connection::setResponse(Reply&& reply)
+{
+    if (isResponseSet())
+        throw response_already_set_error;
+
+    if (reply.isDeferred())
+    {
+        delayedResponse = reply.toFuture();
+        delayedResponseSet = true;
+        return;
+    }
+    response = reply.get();
+    _encodeResponse();
+    responseFinalized = true;
+}
+
+Response Connection::takeDelayedResponse()
+{
+    delayedResponseSet = false;
+    try
+    {
+        return delayedResponse.get();
+    }
+    catch (const std::future_error&)
+    {
+        return Response{Code::INTERNAL_SERVER_ERROR};
+    }
 }
 
 void Connection::setCorsResponseHeaders(CorsResponseHeaders&& headers)
@@ -98,6 +208,26 @@ void Connection::setCorsResponseHeaders(CorsResponseHeaders&& headers)
     responseFinalized = true;
 }
 
+std::shared_ptr<ResponderState> Connection::setResponder(
+    ResponderState::Post post)
+{
+    if (isResponseSet())
+        throw response_already_set_error;
+
+    responder = std::make_shared<ResponderState>(*this, std::move(post),
+                                                 responseEncoder,
+                                                 responseOffload);
+    delayedResponseSet = true;
+    return responder;
+}
+
+void Connection::rejectRequest(const Code code)
+{
+    response = Response{code};
+    responseFinalized = true;
+    requestRejected = true;
+}
+
 bool Connection::isResponseSet() const
 {
     return delayedResponseSet || responseFinalized;
@@ -105,7 +235,14 @@ bool Connection::isResponseSet() const
 
 bool Connection::isResponseReady() const
 {
-    return responseFinalized || is_ready(delayedResponse);
+    if (responseFinalized)
+        return true;
+    return responder ? responder->isCompleted() : is_ready(delayedResponse);
+}
+
+bool Connection::isWokenUpWhenResponseReady() const
+{
+    return responder && responder->wakesUpConnection();
 }
 
 void Connection::requestWriteCallback()
@@ -124,7 +261,12 @@ int Connection::writeResponseHeaders()
         _finalizeResponse();
 
     responseHeadersSent = true;
-    return channel.writeResponseHeaders(corsResponseHeaders, response);
+    const auto ret =
+        channel.writeResponseHeaders(corsResponseHeaders, response);
+
+    // The remaining body of a rejected request must not be read as a new one
+    const bool hasBody = !response.body.empty() || response.isStreamed();
+    return requestRejected && !hasBody ? -1 : ret;
 }
 
 int Connection::writeResponseBody()
@@ -137,11 +279,53 @@ int Connection::writeResponseBody()
 #else
         return 0;
 #endif
-    if (response.body.empty())
+    if (response.body.empty() && !response.isStreamed())
         throw body_empty_error;
 
-    responseBodySent = true;
-    return channel.writeResponseBody(response);
+    // Write the body in bounded parts, one per writable callback, and only
+    // when the socket can accept more data, so that large bodies are neither
+    // copied at once nor flooding the lws and kernel buffers.
+    if (channel.isSendPipeChoked())
+    {
+        requestWriteCallback();
+        return 0;
+    }
+
+    if (responseBodyBuffer.empty())
+    {
+        responseBodyBuffer.resize(Channel::bodyPartHeadroom +
+                                  MAX_BODY_PART_SIZE +
+                                  Channel::bodyPartTailroom);
+    }
+    auto data = responseBodyBuffer.data() + Channel::bodyPartHeadroom;
+    size_t size = 0;
+    try
+    {
+        size = _readResponseBodyPart((char*)data, MAX_BODY_PART_SIZE);
+    }
+    catch (...)
+    {
+        return -1; // producer failure, the response can only be aborted
+    }
+    responseBodyBytesSent += size;
+
+    const bool chunked = response.isStreamed() && response.bodySize == 0;
+    bool last = false;
+    if (chunked)
+        last = size == 0;
+    else if (size == 0)
+        return -1; // streamed body shorter than announced
+    else
+    {
+        const auto bodySize = response.isStreamed() ? response.bodySize
+                                                    : response.body.size();
+        last = responseBodyBytesSent >= bodySize;
+    }
+
+    if (last)
+        responseBodySent = true;
+    const auto ret = channel.writeResponseBodyPart(data, size, chunked, last);
+    return requestRejected && last ? -1 : ret;
 }
 
 bool Connection::wereResponseHeadersSent() const
@@ -169,11 +353,44 @@ CorsResponseHeaders Connection::_getCorsResponseHeaders() const
     return {{CorsResponseHeader::access_control_allow_origin, "*"}};
 }
 
+size_t Connection::_readResponseBodyPart(char* data, size_t size)
+{
+    if (response.isStreamed())
+    {
+        if (response.bodySize > 0)
+            size = std::min(size, response.bodySize - responseBodyBytesSent);
+        return std::min(response.bodyProducer(data, size), size);
+    }
+    size = std::min(size, response.body.size() - responseBodyBytesSent);
+    memcpy(data, response.body.data() + responseBodyBytesSent, size);
+    return size;
+}
+
+bool Connection::_spillBodyToFile()
+{
+    bodyFile.reset(createTempFile(request.bodyFile));
+    if (!bodyFile)
+        return false;
+
+    const auto size = request.body.size();
+    const bool written =
+        std::fwrite(request.body.data(), 1, size, bodyFile.get()) == size;
+    std::string().swap(request.body);
+    return written;
+}
+
 void Connection::_finalizeResponse()
 {
+    if (responder)
+    {
+        response = responder->takeResponse();
+        responseFinalized = true;
+        return;
+    }
     try
     {
         response = delayedResponse.get();
+        _encodeResponse();
     }
     catch (const std::future_error&)
     {
@@ -181,5 +398,11 @@ void Connection::_finalizeResponse()
     }
     responseFinalized = true;
 }
+
+void Connection::_encodeResponse()
+{
+    if (responseEncoder)
+        responseEncoder(response);
+}
 }
 }
@@ -20,13 +20,19 @@
 #ifndef ROCKETS_HTTP_CONNECTION_H
 #define ROCKETS_HTTP_CONNECTION_H
 
+#include <rockets/http/bodySink.h>
 #include <rockets/http/channel.h>
 #include <rockets/http/cors.h>
 #include <rockets/http/request.h>
+#include <rockets/http/responderState.h>
 #include <rockets/http/types.h>
 
 #include <libwebsockets.h>
 
+#include <cstdio>
+#include <memory>
+#include <vector>
+
 namespace rockets
 {
 namespace http
@@ -38,6 +44,10 @@ class Connection
 {
 public:
     Connection(lws* wsi, const char* path);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
 
     // request
 
@@ -45,21 +55,56 @@ public:
     Method getMethod() const;
 
     bool canHaveHttpBody() const;
-    void appendBody(const char* in, const size_t len);
+    void setBodyOptions(const BodyOptions& options);
+    void setBodySink(std::unique_ptr<BodySink> sink);
+    BodySink* getBodySink() { return bodySink.get(); }
+    void discardBody();
+    bool exceedsMaxBodySize() const;
+
+    /** @return false if the body exceeds the maximum size or failed. */
+    bool appendBody(const char* in, const size_t len);
+
+    /** @return false if the body could not be written completely. */
+    bool endBody();
 
     bool isCorsPreflightRequest() const;
 
     const Request& getRequest() const { return request; }
-    void overwriteRequestPath(std::string path);
+    void overwriteRequestPath(std::string path,
+                              std::map<std::string, std::string> pathParams);
 
     // response
 
-    void setResponse(std::future<Response>&& futureResponse);
+    /**
+     * Set the function encoding the response before it is set, and the one
+     * encoding the responses of the responder on another thread.
+     */
+    void setResponseEncoder(ResponderState::Encode encode,
+                            ResponderState::Offload offload = {});
+
+    void setResponse(Reply&& reply);
+
+    /** @return true if the response is a future which was not taken yet. */
+    bool hasDelayedResponse() const { return delayedResponse.valid(); }
+
+    /** Take the ready future response, to set the response again. */
+    Response takeDelayedResponse();
     void setCorsResponseHeaders(CorsResponseHeaders&& headers);
 
+    /** Set the response to be given later through the returned state. */
+    std::shared_ptr<ResponderState> setResponder(ResponderState::Post post);
+
+    /** Respond with an error and close the connection, the body is ignored. */
+    void rejectRequest(Code code);
+    bool isRequestRejected() const { return requestRejected; }
+
     bool isResponseSet() const;
     bool isResponseReady() const;
 
+    /** @return true if the connection is woken up once the response is ready,
+     *          false if it must be polled. */
+    bool isWokenUpWhenResponseReady() const;
+
     void requestWriteCallback();
 
     int writeResponseHeaders();
@@ -71,21 +116,36 @@ private:
     Channel channel;
     Request request;
     size_t contentLength = 0;
+    size_t bodySize = 0;
+    BodyOptions bodyOptions;
+    std::unique_ptr<BodySink> bodySink;
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> bodyFile{nullptr,
+                                                             &std::fclose};
+    bool bodyDiscarded = false;
+    bool requestRejected = false;
     CorsRequestHeaders corsHeaders;
 
     CorsResponseHeaders corsResponseHeaders;
     std::future<Response> delayedResponse;
+    std::shared_ptr<ResponderState> responder;
+    ResponderState::Encode responseEncoder;
+    ResponderState::Offload responseOffload;
     bool delayedResponseSet = false;
     bool responseFinalized = false;
     Response response;
 
     bool responseHeadersSent = false;
     bool responseBodySent = false;
+    size_t responseBodyBytesSent = 0;
+    std::vector<unsigned char> responseBodyBuffer;
 
     bool _canHaveHttpBody(Method m) const;
     bool _hasCorsPreflightHeaders() const;
     CorsResponseHeaders _getCorsResponseHeaders() const;
     void _finalizeResponse();
+    void _encodeResponse();
+    bool _spillBodyToFile();
+    size_t _readResponseBodyPart(char* data, size_t size);
 };
 }
 }
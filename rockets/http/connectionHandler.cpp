@@ -19,34 +19,54 @@
 
 #include "connectionHandler.h"
 
-#include "helpers.h"
+#include "reply.h"
 #include "request.h"
+#include "responder.h"
 #include "response.h"
 
+#include "../workerPool.h"
+
 namespace
 {
 const std::string JSON_TYPE = "application/json";
 const std::string REQUEST_REGISTRY = "registry";
 
 const int codeContinue = 0;
+} // anonymous namespace
 
-std::string _removeEndpointFromPath(const std::string& endpoint,
-                                    const std::string& path)
+namespace rockets
+{
+namespace http
 {
-    if (endpoint == "/")
-        return path;
+namespace
+{
+ResponderState::Offload _makeOffload(
+    std::shared_ptr<const Compressor> compressor, const std::string& encoding,
+    ResponderState::Encode encode, std::weak_ptr<WorkerPool> weakExecutor)
+{
+    return [=](Response& response, std::function<void(Response)> done) {
+        if (!compressor->canCompress(response, encoding))
+            return false;
 
-    if (endpoint.size() >= path.size())
-        return std::string();
+        auto shared = std::make_shared<Response>(std::move(response));
+        auto task = [shared, encode, done] {
+            encode(*shared);
+            done(std::move(*shared));
+        };
+        auto executor = weakExecutor.lock();
+        if (executor && executor->post(std::move(task)))
+            return true;
 
-    return path.substr(endpoint.size());
+        // Send the payload uncompressed if the queue is full, rather than
+        // compressing it on the calling thread which may serve connections.
+        response = std::move(*shared);
+        compressor->compress(response, std::string(), std::string());
+        done(std::move(response));
+        return true;
+    };
 }
 } // anonymous namespace
 
-namespace rockets
-{
-namespace http
-{
 ConnectionHandler::ConnectionHandler(const Registry& registry)
     : _registry(registry)
 {
@@ -57,22 +77,64 @@ void ConnectionHandler::setFilter(const Filter* filter)
     _filter = filter;
 }
 
+void ConnectionHandler::setExecutor(WorkerPool* executor)
+{
+    _executor = executor;
+}
+
+void ConnectionHandler::setPosterFactory(PosterFactory factory)
+{
+    _posterFactory = std::move(factory);
+}
+
+void ConnectionHandler::setCompressor(
+    std::shared_ptr<const Compressor> compressor,
+    std::shared_ptr<WorkerPool> executor)
+{
+    _compressor = std::move(compressor);
+    _compressionExecutor = _compressor ? std::move(executor) : nullptr;
+}
+
 void ConnectionHandler::handleNewRequest(Connection& connection) const
 {
     if (connection.isCorsPreflightRequest())
         _prepareCorsPreflightResponse(connection);
     else if (!connection.canHaveHttpBody())
         prepareResponse(connection);
+    else
+        _prepareBodyReception(connection);
 }
 
 void ConnectionHandler::handleData(Connection& connection, const char* data,
                                    const size_t size) const
 {
-    connection.appendBody(data, size);
+    bool appended = false;
+    try
+    {
+        appended = connection.appendBody(data, size);
+    }
+    catch (...) // from BodySink::onData()
+    {
+    }
+    if (appended || connection.isRequestRejected())
+        return;
+
+    connection.rejectRequest(connection.exceedsMaxBodySize()
+                                 ? Code::PAYLOAD_TOO_LARGE
+                                 : Code::INTERNAL_SERVER_ERROR);
+    connection.requestWriteCallback();
 }
 
 void ConnectionHandler::prepareResponse(Connection& connection) const
 {
+    if (connection.isRequestRejected())
+        return;
+    if (!connection.endBody())
+    {
+        connection.rejectRequest(Code::INTERNAL_SERVER_ERROR);
+        connection.requestWriteCallback();
+        return;
+    }
 #if LWS_LIBRARY_VERSION_NUMBER >= 3001000
     // Since lws 3.1 LWS_CALLBACK_HTTP_BODY + LWS_CALLBACK_HTTP_BODY_COMPLETION
     // happen even when the POST request has ContentLength 0. Return to avoid a
@@ -80,7 +142,13 @@ void ConnectionHandler::prepareResponse(Connection& connection) const
     if (!connection.canHaveHttpBody() && connection.isResponseSet())
         return;
 #endif
-    connection.setResponse(_generateResponse(connection));
+    // Filtered requests are answered once their discarded payload is received
+    if (connection.canHaveHttpBody() && connection.isResponseSet())
+    {
+        connection.requestWriteCallback();
+        return;
+    }
+    _generateResponse(connection);
     connection.requestWriteCallback();
 }
 
@@ -91,39 +159,116 @@ int ConnectionHandler::writeResponse(Connection& connection) const
 
     if (!connection.isResponseReady())
     {
-        // Keep polling until response is ready
-        connection.requestWriteCallback();
+        // Keep polling until response is ready, unless woken up by it
+        if (!connection.isWokenUpWhenResponseReady())
+            connection.requestWriteCallback();
         return codeContinue;
     }
 
     if (!connection.wereResponseHeadersSent())
+    {
+        // compress a deferred response off the service thread once ready
+        if (_compressionExecutor && connection.hasDelayedResponse())
+        {
+            _setResponse(connection, connection.takeDelayedResponse());
+            if (!connection.isResponseReady())
+                return codeContinue;
+        }
         return connection.writeResponseHeaders();
+    }
 
     return connection.writeResponseBody();
 }
 
-std::future<Response> ConnectionHandler::_generateResponse(
-    Connection& connection) const
+void ConnectionHandler::_prepareBodyReception(Connection& connection) const
+{
+    // Filter before the payload reaches a BodySink or a file
+    const auto& request = connection.getRequest();
+    if (_filter && _filter->filter(request))
+    {
+        _setResponseEncoder(connection);
+        connection.setResponse(_filter->getResponse(request));
+        connection.discardBody();
+        return;
+    }
+
+    auto result = _findHandler(connection);
+    if (!result.found)
+    {
+        // The response can only be an error, don't store the payload
+        connection.discardBody();
+        return;
+    }
+
+    const auto& handler = *result.handler;
+    connection.setBodyOptions(handler.bodyOptions);
+    if (connection.exceedsMaxBodySize())
+    {
+        // Reject before receiving anything, based on the Content-Length
+        connection.rejectRequest(Code::PAYLOAD_TOO_LARGE);
+        connection.requestWriteCallback();
+        return;
+    }
+
+    if (handler.sinkFactory)
+    {
+        connection.overwriteRequestPath(std::move(result.path),
+                                        std::move(result.pathParams));
+        try
+        {
+            connection.setBodySink(handler.sinkFactory(request));
+        }
+        catch (...)
+        {
+        }
+        if (!connection.getBodySink())
+        {
+            connection.rejectRequest(Code::INTERNAL_SERVER_ERROR);
+            connection.requestWriteCallback();
+        }
+    }
+}
+
+Registry::SearchResult ConnectionHandler::_findHandler(
+    const Connection& connection) const
 {
+    return _registry.findEndpoint(connection.getMethod(),
+                                  connection.getPathWithoutLeadingSlash());
+}
+
+void ConnectionHandler::_generateResponse(Connection& connection) const
+{
+    _setResponseEncoder(connection);
+
     const auto& request = connection.getRequest();
     if (_filter && _filter->filter(request))
-        return make_ready_response(_filter->getResponse(request));
+    {
+        connection.setResponse(_filter->getResponse(request));
+        return;
+    }
+
+    if (auto sink = connection.getBodySink())
+    {
+        _setResponse(connection, sink->onComplete(request));
+        return;
+    }
 
     const auto path = connection.getPathWithoutLeadingSlash();
 
     if (connection.getMethod() == Method::GET && path == REQUEST_REGISTRY)
-        return make_ready_response(Code::OK, _registry.toJson(), JSON_TYPE);
+    {
+        _setResponse(connection,
+                     Response{Code::OK, _registry.toJson(), JSON_TYPE});
+        return;
+    }
 
-    const auto result = _registry.findEndpoint(connection.getMethod(), path);
+    auto result = _findHandler(connection);
     if (result.found)
     {
-        const auto& endpoint = result.endpoint;
-        const auto pathStripped = _removeEndpointFromPath(endpoint, path);
-        if (pathStripped.empty() || *endpoint.rbegin() == '/')
-        {
-            connection.overwriteRequestPath(pathStripped);
-            return _callHandler(connection, endpoint);
-        }
+        connection.overwriteRequestPath(std::move(result.path),
+                                        std::move(result.pathParams));
+        _callHandler(connection, *result.handler);
+        return;
     }
 
     // return informative error 405 "Method Not Allowed" if possible
@@ -131,18 +276,137 @@ std::future<Response> ConnectionHandler::_generateResponse(
     if (!allowedMethods.empty())
     {
         Response::Headers headers{{Header::ALLOW, allowedMethods}};
-        return make_ready_response(Code::NOT_SUPPORTED, std::string(),
-                                   std::move(headers));
+        connection.setResponse(
+            Response{Code::NOT_SUPPORTED, std::string(), std::move(headers)});
+        return;
     }
 
-    return make_ready_response(Code::NOT_FOUND);
+    connection.setResponse(Response{Code::NOT_FOUND});
+}
+
+void ConnectionHandler::_setResponseEncoder(Connection& connection) const
+{
+    if (!_compressor)
+        return;
+
+    const auto& request = connection.getRequest();
+    const auto encoding = _compressor->negotiate(request);
+    auto encode = [ compressor = _compressor, encoding,
+                    path = request.path ](Response& response)
+    {
+        compressor->compress(response, encoding, path);
+    };
+    if (!_compressionExecutor)
+    {
+        connection.setResponseEncoder(std::move(encode));
+        return;
+    }
+
+    connection.setResponseEncoder(encode,
+                                  _makeOffload(_compressor, encoding, encode,
+                                               _compressionExecutor));
+}
+
+void ConnectionHandler::_setResponse(Connection& connection,
+                                     Reply&& reply) const
+{
+    if (!_compressionExecutor || reply.isDeferred())
+    {
+        // deferred responses are compressed by writeResponse() once ready
+        connection.setResponse(std::move(reply));
+        return;
+    }
+
+    // the responder wakes up the connection once the payload is compressed
+    auto response = reply.get();
+    const auto encoding = _compressor->negotiate(connection.getRequest());
+    if (_compressor->canCompress(response, encoding))
+        connection.setResponder(_getPoster())->complete(std::move(response));
+    else
+        connection.setResponse(std::move(response));
+}
+
+void ConnectionHandler::_callHandler(Connection& connection,
+                                     const Registry::Handler& handler) const
+{
+    const auto& request = connection.getRequest();
+    if (handler.sinkFactory)
+    {
+        // streaming endpoint called without payload
+        try
+        {
+            connection.setBodySink(handler.sinkFactory(request));
+        }
+        catch (...)
+        {
+        }
+        if (auto sink = connection.getBodySink())
+            _setResponse(connection, sink->onComplete(request));
+        else
+            connection.setResponse(Response{Code::INTERNAL_SERVER_ERROR});
+        return;
+    }
+
+    if (handler.asyncFunc)
+    {
+        const Responder responder{connection.setResponder(_getPoster())};
+        if (_executor)
+        {
+            _executeHandler(
+                [ func = handler.asyncFunc, request, responder ] {
+                    func(request, responder);
+                },
+                responder);
+            return;
+        }
+        try
+        {
+            handler.asyncFunc(request, responder);
+        }
+        catch (...)
+        {
+            responder.respond(Response{Code::INTERNAL_SERVER_ERROR});
+        }
+        return;
+    }
+
+    if (_executor)
+    {
+        const Responder responder{connection.setResponder(_getPoster())};
+        _executeHandler(
+            [ func = handler.func, request, responder ] {
+                responder.respond(func(request).get());
+            },
+            responder);
+        return;
+    }
+    _setResponse(connection, handler.func(request));
+}
+
+void ConnectionHandler::_executeHandler(std::function<void()> handler,
+                                        const Responder& responder) const
+{
+    // The handler must hold a copy of the request, as the connection may be
+    // closed before it gets executed. The service thread of the connection
+    // is woken up by the responder, which is then responsible for writing.
+    auto task = [ handler = std::move(handler), responder ]
+    {
+        try
+        {
+            handler();
+        }
+        catch (...)
+        {
+            responder.respond(Response{Code::INTERNAL_SERVER_ERROR});
+        }
+    };
+    if (!_executor->post(std::move(task)))
+        responder.respond(Response{Code::SERVICE_UNAVAILABLE});
 }
 
-std::future<Response> ConnectionHandler::_callHandler(
-    const Connection& connection, const std::string& endpoint) const
+ResponderState::Post ConnectionHandler::_getPoster() const
 {
-    const auto& func = _registry.getFunction(connection.getMethod(), endpoint);
-    return func(connection.getRequest());
+    return _posterFactory ? _posterFactory() : ResponderState::Post();
 }
 
 void ConnectionHandler::_prepareCorsPreflightResponse(
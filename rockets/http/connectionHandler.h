@@ -20,6 +20,7 @@
 #ifndef ROCKETS_HTTP_CONNECTION_HANDLER_H
 #define ROCKETS_HTTP_CONNECTION_HANDLER_H
 
+#include <rockets/http/compressor.h>
 #include <rockets/http/connection.h>
 #include <rockets/http/filter.h>
 #include <rockets/http/registry.h>
@@ -27,6 +28,8 @@
 
 namespace rockets
 {
+class WorkerPool;
+
 namespace http
 {
 /**
@@ -39,12 +42,46 @@ namespace http
  * It also answers CORS preflight requests directly.
  *
  * Incoming connections can optionally be filtered out by setting a Filter.
+ * Requests with a payload are filtered before receiving it, which is then
+ * discarded if the request is blocked.
+ *
+ * Handlers are called from the thread serving the connection, unless an
+ * executor is set in which case they are run on its worker threads. The
+ * endpoint of requests with a payload is resolved before receiving it, to
+ * enforce its BodyOptions or stream the payload to a BodySink. BodySinks are
+ * always used from the thread serving the connection.
+ *
+ * Responses are compressed if a Compressor is set. If it comes with its own
+ * executor, the payloads are compressed by its worker threads which then wake
+ * up the connection like a Responder does. Otherwise they are compressed from
+ * the thread producing them.
  */
 class ConnectionHandler
 {
 public:
+    /** Returns a function posting tasks to the calling service thread. */
+    using PosterFactory = std::function<ResponderState::Post()>;
+
     ConnectionHandler(const Registry& registry);
     void setFilter(const Filter* filter);
+    void setExecutor(WorkerPool* executor);
+
+    /**
+     * Set the factory used to wake up connections when their asynchronous
+     * response is ready. Without it, pending responses are polled.
+     */
+    void setPosterFactory(PosterFactory factory);
+
+    /**
+     * Set the compressor of the responses, nullptr to remove.
+     *
+     * @param compressor of the responses.
+     * @param executor optional worker threads compressing the payloads. The
+     *        Responders, which may outlive the server, only keep a weak
+     *        reference to it.
+     */
+    void setCompressor(std::shared_ptr<const Compressor> compressor,
+                       std::shared_ptr<WorkerPool> executor = nullptr);
 
     void handleNewRequest(Connection& connection) const;
     void handleData(Connection& connection, const char* data,
@@ -54,12 +91,23 @@ public:
 
 private:
     const http::Filter* _filter = nullptr;
+    WorkerPool* _executor = nullptr;
+    PosterFactory _posterFactory;
+    std::shared_ptr<const Compressor> _compressor;
+    std::shared_ptr<WorkerPool> _compressionExecutor;
     const Registry& _registry;
 
     void _prepareCorsPreflightResponse(Connection& connection) const;
-    std::future<Response> _generateResponse(Connection& connection) const;
-    std::future<Response> _callHandler(const Connection& connection,
-                                       const std::string& endpoint) const;
+    void _prepareBodyReception(Connection& connection) const;
+    Registry::SearchResult _findHandler(const Connection& connection) const;
+    void _generateResponse(Connection& connection) const;
+    void _setResponseEncoder(Connection& connection) const;
+    void _setResponse(Connection& connection, Reply&& reply) const;
+    void _callHandler(Connection& connection,
+                      const Registry::Handler& handler) const;
+    void _executeHandler(std::function<void()> handler,
+                         const Responder& responder) const;
+    ResponderState::Post _getPoster() const;
     CorsResponseHeaders _makeCorsPreflighResponseHeaders(
         const std::string& path) const;
 };
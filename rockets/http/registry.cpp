@@ -21,86 +21,354 @@
 
 #include "registry.h"
 
+#include "reply.h"
+#include "utils.h"
+
 #include "../json.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace rockets
 {
 namespace http
 {
+namespace
+{
+const unsigned int ALL_METHODS = (1u << int(Method::ALL)) - 1;
+
+enum class ParamType
+{
+    INT,
+    STRING
+};
+
+struct Segment
+{
+    std::string name; // literal value or parameter name
+    bool isParam;
+    ParamType type;
+};
+
+Segment _parseSegment(const std::string& segment)
+{
+    if (segment.size() < 2 || segment.front() != '{' || segment.back() != '}')
+        return {segment, false, ParamType::STRING};
+
+    const auto colon = std::min(segment.find(':'), segment.size() - 1);
+    const auto name = segment.substr(1, colon - 1);
+    const auto type = segment.substr(colon + 1, segment.size() - colon - 2);
+    if (name.empty())
+        throw std::invalid_argument("unnamed path parameter: " + segment);
+    if (type.empty() || type == "string")
+        return {name, true, ParamType::STRING};
+    if (type == "int")
+        return {name, true, ParamType::INT};
+    throw std::invalid_argument("unknown path parameter type: " + segment);
+}
+
+bool _isPrefix(const std::string& endpoint)
+{
+    return !endpoint.empty() && endpoint.back() == '/';
+}
+
+std::vector<Segment> _parseEndpoint(const std::string& endpoint)
+{
+    std::vector<Segment> segments;
+    if (endpoint.empty() || endpoint == "/")
+        return segments;
+
+    const auto end = endpoint.size() - (_isPrefix(endpoint) ? 1 : 0);
+    size_t pos = 0;
+    for (;;)
+    {
+        const auto next = std::min(endpoint.find('/', pos), end);
+        segments.push_back(_parseSegment(endpoint.substr(pos, next - pos)));
+        if (next == end)
+            return segments;
+        pos = next + 1;
+    }
+}
+
+bool _accepts(const ParamType type, const std::string& path, size_t pos,
+              const size_t length)
+{
+    if (length == 0)
+        return false;
+    if (type == ParamType::STRING)
+        return true;
+
+    const auto end = pos + length;
+    if (path[pos] == '-' && length > 1)
+        ++pos;
+    return std::all_of(path.begin() + pos, path.begin() + end, [](char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+    });
+}
+} // anonymous namespace
+
+struct Registry::Endpoint
+{
+    std::string name;
+    std::array<Handler, size_t(Method::ALL)> handlers;
+    unsigned int methods = 0; // bit mask of the handled methods
+};
+
+struct Registry::Match
+{
+    const Endpoint* endpoint = nullptr;
+    size_t pos = 0; // start of the remainder of the path
+    std::map<std::string, std::string> params;
+};
+
+struct Registry::Node
+{
+    // Nodes are shared between snapshots, they are copied before being
+    // modified and never modified once published.
+    using NodePtr = std::shared_ptr<Node>;
+
+    struct Param
+    {
+        std::string name;
+        ParamType type;
+        NodePtr node;
+    };
+
+    std::unordered_map<std::string, NodePtr> children;
+    std::vector<Param> params; // integer parameters first
+    Endpoint exact;
+    Endpoint prefix;
+
+    NodePtr* findChild(const Segment& segment)
+    {
+        if (!segment.isParam)
+        {
+            const auto it = children.find(segment.name);
+            return it == children.end() ? nullptr : &it->second;
+        }
+        for (auto& param : params)
+            if (param.name == segment.name && param.type == segment.type)
+                return &param.node;
+        return nullptr;
+    }
+
+    const Node* find(const Segment& segment) const
+    {
+        if (!segment.isParam)
+        {
+            const auto it = children.find(segment.name);
+            return it == children.end() ? nullptr : it->second.get();
+        }
+        for (const auto& param : params)
+            if (param.name == segment.name && param.type == segment.type)
+                return param.node.get();
+        return nullptr;
+    }
+
+    /** @return a private copy of the child, created if it did not exist. */
+    Node& copyOrCreate(const Segment& segment)
+    {
+        if (auto child = findChild(segment))
+        {
+            *child = std::make_shared<Node>(**child);
+            return **child;
+        }
+
+        auto node = std::make_shared<Node>();
+        if (!segment.isParam)
+            children[segment.name] = node;
+        else if (segment.type == ParamType::INT)
+            params.insert(params.begin(), {segment.name, segment.type, node});
+        else
+            params.push_back({segment.name, segment.type, node});
+        return *node;
+    }
+
+    void erase(const Segment& segment)
+    {
+        if (!segment.isParam)
+        {
+            children.erase(segment.name);
+            return;
+        }
+        params.erase(std::remove_if(params.begin(), params.end(),
+                                    [&segment](const Param& param) {
+                                        return param.name == segment.name &&
+                                               param.type == segment.type;
+                                    }),
+                     params.end());
+    }
+
+    bool isEmpty() const
+    {
+        return children.empty() && params.empty() && exact.methods == 0 &&
+               prefix.methods == 0;
+    }
+
+    /**
+     * Match the remainder of the path starting at pos, or npos if the path
+     * ends at this node, trying the most specific endpoints first.
+     */
+    bool match(const std::string& path, const size_t pos,
+               const unsigned int methods, Match& result) const
+    {
+        if (pos == std::string::npos)
+        {
+            if (!(exact.methods & methods))
+                return false;
+            result.endpoint = &exact;
+            result.pos = path.size();
+            return true;
+        }
+
+        const auto end = path.find('/', pos);
+        const auto next = end == std::string::npos ? end : end + 1;
+        const auto length = std::min(end, path.size()) - pos;
+
+        if (!children.empty())
+        {
+            const auto it = children.find(path.substr(pos, length));
+            if (it != children.end() &&
+                it->second->match(path, next, methods, result))
+            {
+                return true;
+            }
+        }
+        for (const auto& param : params)
+        {
+            if (!_accepts(param.type, path, pos, length))
+                continue;
+            result.params[param.name] = path.substr(pos, length);
+            if (param.node->match(path, next, methods, result))
+                return true;
+            result.params.erase(param.name);
+        }
+        if (!(prefix.methods & methods))
+            return false;
+        result.endpoint = &prefix;
+        result.pos = pos;
+        return true;
+    }
+
+    void collect(std::vector<const Endpoint*>& endpoints) const
+    {
+        if (exact.methods)
+            endpoints.push_back(&exact);
+        if (prefix.methods)
+            endpoints.push_back(&prefix);
+        for (const auto& child : children)
+            child.second->collect(endpoints);
+        for (const auto& param : params)
+            param.node->collect(endpoints);
+    }
+};
+
+Registry::Registry()
+    : _snapshot{std::make_shared<Node>()}
+{
+}
+
+Registry::~Registry() = default;
+
+bool Registry::add(const Method method, const std::string& endpoint,
+                   ReplyFunc func)
+{
+    return add(method, endpoint, Handler{std::move(func), {}, {}, {}});
+}
+
 bool Registry::add(const Method method, const std::string& endpoint,
-                   RESTFunc func)
+                   Handler handler)
 {
-    if (_methods[int(method)].count(endpoint) != 0)
+    const auto segments = _parseEndpoint(endpoint);
+    const auto bit = 1u << int(method);
+
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    if (contains(method, endpoint))
         return false;
 
-    _methods[int(method)][endpoint] = func;
+    auto root = std::make_shared<Node>(*_snapshot);
+    auto node = root.get();
+    for (const auto& segment : segments)
+        node = &node->copyOrCreate(segment);
+
+    auto& entry = _isPrefix(endpoint) ? node->prefix : node->exact;
+    entry.name = endpoint;
+    entry.handlers[int(method)] = std::move(handler);
+    entry.methods |= bit;
+
+    std::atomic_store(&_snapshot, Snapshot{std::move(root)});
     return true;
 }
 
 bool Registry::remove(const std::string& endpoint)
 {
-    bool foundMethod = false;
-    for (auto& method : _methods)
-        if (method.erase(endpoint) != 0)
-            foundMethod = true;
-    return foundMethod;
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    const auto entry = _find(*_snapshot, endpoint);
+    if (!entry || entry->methods == 0)
+        return false;
+
+    const auto segments = _parseEndpoint(endpoint);
+    auto root = std::make_shared<Node>(*_snapshot);
+    std::vector<Node*> nodes{root.get()};
+    for (const auto& segment : segments)
+        nodes.push_back(&nodes.back()->copyOrCreate(segment));
+
+    auto node = nodes.back();
+    (_isPrefix(endpoint) ? node->prefix : node->exact) = Endpoint();
+
+    // remove the nodes left empty along the path
+    for (size_t i = segments.size(); i > 0 && nodes[i]->isEmpty(); --i)
+        nodes[i - 1]->erase(segments[i - 1]);
+
+    std::atomic_store(&_snapshot, Snapshot{std::move(root)});
+    return true;
 }
 
 bool Registry::contains(const Method method, const std::string& endpoint) const
 {
-    const auto& funcMap = _methods[int(method)];
-    return funcMap.count(endpoint);
+    const auto entry = _find(*_getSnapshot(), endpoint);
+    return entry && (entry->methods & (1u << int(method)));
 }
 
-RESTFunc Registry::getFunction(const Method method,
-                               const std::string& endpoint) const
+std::string Registry::getAllowedMethods(const std::string& path) const
 {
-    const auto& funcMap = _methods[int(method)];
-    return funcMap.at(endpoint);
-}
+    const auto match = _match(*_getSnapshot(), path, ALL_METHODS);
+    if (!match.endpoint)
+        return std::string();
 
-std::string Registry::getAllowedMethods(const std::string& endpoint) const
-{
     std::string methods;
-    if (contains(Method::GET, endpoint))
-        methods.append(methods.empty() ? "GET" : ", GET");
-    if (contains(Method::POST, endpoint))
-        methods.append(methods.empty() ? "POST" : ", POST");
-    if (contains(Method::PUT, endpoint))
-        methods.append(methods.empty() ? "PUT" : ", PUT");
-    if (contains(Method::PATCH, endpoint))
-        methods.append(methods.empty() ? "PATCH" : ", PATCH");
-    if (contains(Method::DELETE, endpoint))
-        methods.append(methods.empty() ? "DELETE" : ", DELETE");
-    if (contains(Method::OPTIONS, endpoint))
-        methods.append(methods.empty() ? "OPTIONS" : ", OPTIONS");
+    for (int method = 0; method < int(Method::ALL); ++method)
+    {
+        if (!(match.endpoint->methods & (1u << method)))
+            continue;
+        if (!methods.empty())
+            methods.append(", ");
+        methods.append(to_cstring(Method(method)));
+    }
     return methods;
 }
 
 Registry::SearchResult Registry::findEndpoint(const Method method,
                                               const std::string& path) const
 {
-    const auto& funcMap = _methods[int(method)];
-    auto it = _find(funcMap, path);
-    if (it != funcMap.end())
-        return {true, it->first};
-
-    if (contains(method, "/")) // "/" should be passed all unhandled requests.
-        return {true, "/"};
-
-    return {false, std::string()};
-}
+    const auto snapshot = _getSnapshot();
+    auto match = _match(*snapshot, path, 1u << int(method));
+    if (!match.endpoint)
+        return SearchResult();
 
-Registry::FuncMap::const_iterator Registry::_find(
-    const Registry::FuncMap& funcMap, const std::string& path) const
-{
-    const auto beginsWithPath = [&path](const FuncMap::value_type& pair) {
-        const auto& endpoint = pair.first;
-        return endpoint.empty() ? path.empty() : path.find(endpoint) == 0;
-    };
-    return std::find_if(funcMap.begin(), funcMap.end(), beginsWithPath);
+    SearchResult result;
+    result.found = true;
+    result.endpoint = match.endpoint->name;
+    // shares the ownership of the snapshot containing the handler
+    result.handler = std::shared_ptr<const Handler>(
+        snapshot, &match.endpoint->handlers[int(method)]);
+    result.path = path.substr(match.pos);
+    result.pathParams = std::move(match.params);
+    return result;
 }
 
 void _append(rockets_nlohmann::json& array, std::string&& value)
@@ -113,20 +381,60 @@ void _append(rockets_nlohmann::json& array, std::string&& value)
 
 std::string Registry::toJson() const
 {
+    const auto snapshot = _getSnapshot();
+    std::vector<const Endpoint*> endpoints;
+    snapshot->collect(endpoints);
+
     auto body = rockets_nlohmann::json();
-    for (const auto& i : _methods[int(Method::GET)])
-        _append(body[i.first], "GET");
-    for (const auto& i : _methods[int(Method::POST)])
-        _append(body[i.first], "POST");
-    for (const auto& i : _methods[int(Method::PUT)])
-        _append(body[i.first], "PUT");
-    for (const auto& i : _methods[int(Method::PATCH)])
-        _append(body[i.first], "PATCH");
-    for (const auto& i : _methods[int(Method::DELETE)])
-        _append(body[i.first], "DELETE");
-    for (const auto& i : _methods[int(Method::OPTIONS)])
-        _append(body[i.first], "OPTIONS");
-    return body.dump(4);
+    for (const auto endpoint : endpoints)
+    {
+        for (int method = 0; method < int(Method::ALL); ++method)
+            if (endpoint->methods & (1u << method))
+                _append(body[endpoint->name], to_cstring(Method(method)));
+    }
+    return body.dump();
+}
+
+Registry::Snapshot Registry::_getSnapshot() const
+{
+    return std::atomic_load(&_snapshot);
+}
+
+const Registry::Endpoint* Registry::_find(const Node& root,
+                                          const std::string& endpoint) const
+{
+    std::vector<Segment> segments;
+    try
+    {
+        segments = _parseEndpoint(endpoint);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return nullptr; // could not have been registered
+    }
+
+    auto node = &root;
+    for (const auto& segment : segments)
+        if (!(node = node->find(segment)))
+            return nullptr;
+    return _isPrefix(endpoint) ? &node->prefix : &node->exact;
+}
+
+Registry::Match Registry::_match(const Node& root, const std::string& path,
+                                 const unsigned int methods) const
+{
+    Match match;
+    const auto pos = path.empty() ? std::string::npos : 0;
+    if (root.match(path, pos, methods, match))
+        return match;
+
+    // "/" also receives the requests to the root
+    if (root.prefix.methods & methods)
+    {
+        match.endpoint = &root.prefix;
+        match.pos = 0;
+    }
+    return match;
 }
 }
 }
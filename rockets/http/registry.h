@@ -24,8 +24,9 @@
 
 #include "types.h"
 
-#include <array>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace rockets
@@ -34,36 +35,81 @@ namespace http
 {
 /**
  * Registry for HTTP endpoints.
+ *
+ * Endpoints are stored in a trie of path segments, so that finding the handler
+ * of a request is proportional to the length of its path and not to the
+ * number of endpoints. The most specific endpoint matching a path is used.
+ *
+ * Endpoint segments can be path parameters, matching any non-empty segment
+ * ("volumes/{id}") or only integers ("volumes/{id}/slices/{z:int}"). Literal
+ * segments have precedence over parameters, and integer parameters over
+ * generic ones.
+ *
+ * Endpoints can be added and removed while requests are served: lookups read
+ * an immutable snapshot of the trie without taking a lock, and writers publish
+ * a new version in which only the nodes along the modified path are copied.
  */
 class Registry
 {
 public:
-    bool add(Method method, const std::string& endpoint, RESTFunc func);
+    /** Handler of an endpoint, either a function or a sink factory. */
+    struct Handler
+    {
+        ReplyFunc func;
+        AsyncRESTFunc asyncFunc;
+        BodySinkFactory sinkFactory;
+        BodyOptions bodyOptions;
+    };
+
+    Registry();
+    ~Registry();
+
+    /** @throw std::invalid_argument if the endpoint has invalid parameters. */
+    bool add(Method method, const std::string& endpoint, ReplyFunc func);
+    /** @throw std::invalid_argument if the endpoint has invalid parameters. */
+    bool add(Method method, const std::string& endpoint, Handler handler);
     bool remove(const std::string& endpoint);
 
     bool contains(Method method, const std::string& endpoint) const;
-    RESTFunc getFunction(Method method, const std::string& endpoint) const;
 
-    std::string getAllowedMethods(const std::string& endpoint) const;
+    /** @return the comma-separated methods of the endpoint matching path. */
+    std::string getAllowedMethods(const std::string& path) const;
 
     struct SearchResult
     {
-        bool found;
+        bool found = false;
         std::string endpoint;
+
+        /** Handler of the endpoint, valid even if it is removed meanwhile. */
+        std::shared_ptr<const Handler> handler;
+
+        /** Remainder of the path after a slash-terminated endpoint. */
+        std::string path;
+
+        /** Values of the path parameters of the endpoint. */
+        std::map<std::string, std::string> pathParams;
     };
     SearchResult findEndpoint(Method method, const std::string& path) const;
 
     std::string toJson() const;
 
 private:
-    // key stores endpoints of Serializable objects lower-case, hyphenated,
-    // with '/' separators
-    // must be an ordered map in order to iterate from the most specific path
-    using FuncMap = std::map<std::string, RESTFunc, std::greater<std::string>>;
-    std::array<FuncMap, size_t(Method::ALL)> _methods;
-
-    FuncMap::const_iterator _find(const Registry::FuncMap& FuncMap,
-                                  const std::string& path) const;
+    struct Endpoint;
+    struct Node;
+    struct Match;
+
+    using Snapshot = std::shared_ptr<const Node>;
+
+    // endpoints are stored at the node of their last segment, a trailing '/'
+    // distinguishes the prefix endpoint from the exact one; "/" is the prefix
+    // endpoint of the root, which receives all unhandled requests.
+    Snapshot _snapshot;
+    std::mutex _writeMutex;
+
+    Snapshot _getSnapshot() const;
+    const Endpoint* _find(const Node& root, const std::string& endpoint) const;
+    Match _match(const Node& root, const std::string& path,
+                 unsigned int methods) const;
 };
 }
 }
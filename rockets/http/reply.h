@@ -0,0 +1,88 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_REPLY_H
+#define ROCKETS_HTTP_REPLY_H
+
+#include <rockets/helpers.h>
+#include <rockets/http/response.h>
+
+#include <future> // member
+
+namespace rockets
+{
+namespace http
+{
+/**
+ * Reply of a ReplyFunc handler: either a ready Response or a future one.
+ *
+ * Returning a Response directly avoids the allocation and synchronization of
+ * the shared state of a std::future for handlers that answer synchronously.
+ */
+class Reply
+{
+public:
+    /** Construct a ready reply. */
+    Reply(Response response)
+        : _response{std::move(response)}
+    {
+    }
+
+    /** Construct a deferred reply, ready when the future is. */
+    Reply(std::future<Response>&& future)
+        : _future{std::move(future)}
+        , _deferred{true}
+    {
+    }
+
+    /** @return true if the reply wraps a future Response. */
+    bool isDeferred() const { return _deferred; }
+
+    /** @return true if the response is available without blocking. */
+    bool isReady() const { return !_deferred || is_ready(_future); }
+
+    /**
+     * @return the response, waiting for it if deferred; can only be called
+     *         once.
+     */
+    Response get() { return _deferred ? _future.get() : std::move(_response); }
+
+    /**
+     * @return the response as a future, ready if not deferred; can only be
+     *         called once.
+     */
+    std::future<Response> toFuture()
+    {
+        if (_deferred)
+            return std::move(_future);
+
+        std::promise<Response> promise;
+        promise.set_value(std::move(_response));
+        return promise.get_future();
+    }
+
+private:
+    Response _response;
+    std::future<Response> _future;
+    bool _deferred = false;
+};
+}
+}
+
+#endif
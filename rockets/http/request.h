@@ -45,12 +45,26 @@ namespace http
  * "api/objects"       || "api/objects"         || ""
  * "api/objects"       || "api/objects/abc"     || ** ENDPOINT NOT FOUND: 404 **
  *
+ * Endpoints can have path parameters, for a single path segment or an integer.
+ * Their values are provided in pathParams.
+ * Registered endpoint         || HTTP request      || pathParams
+ * "api/volumes/{id}"          || "api/volumes/a1"  || {"id": "a1"}
+ * "api/volumes/{id}/{z:int}"  || "api/volumes/a/3" || {"id": "a", "z": "3"}
+ * "api/volumes/{id}/{z:int}"  || "api/volumes/a/b" || ** NOT FOUND: 404 **
+ *
  * The query is the url part after "?".
  * Registered endpoint || HTTP request                 || query    || path
  * "api/objects"       || "api/objects?size=4"         || "size=4" || ""
  * "api/windows/"      || "api/windows/jf321f?size=4"  || "size=4" || "jf321"
  *
+ * The headers are indexed by lower-case name, e.g. "if-none-match". Only the
+ * headers known to libwebsockets are available.
+ *
  * The body is the HTTP request payload.
+ *
+ * The bodyFile is the path of a temporary file containing the payload instead
+ * of the body, if it exceeded the BodyOptions::spillSize of the endpoint. The
+ * file is removed once the connection is closed.
  */
 struct Request
 {
@@ -59,6 +73,9 @@ struct Request
     std::string origin;
     std::map<std::string, std::string> query;
     std::string body;
+    std::string bodyFile;
+    std::map<std::string, std::string> pathParams;
+    std::map<std::string, std::string> headers;
 };
 }
 }
@@ -25,9 +25,11 @@ namespace http
 {
 RequestHandler::RequestHandler(Channel&& channel_, std::string body_,
                                std::function<void(Response)> callback_,
-                               std::function<void(std::string)> errorCallback_)
+                               std::function<void(std::string)> errorCallback_,
+                               std::map<std::string, std::string> headers_)
     : channel{std::move(channel_)}
     , body{std::move(body_)}
+    , headers{std::move(headers_)}
     , callback{std::move(callback_)}
     , errorCallback{std::move(errorCallback_)}
 {
@@ -35,7 +37,7 @@ RequestHandler::RequestHandler(Channel&& channel_, std::string body_,
 
 int RequestHandler::writeHeaders(unsigned char** buffer, const size_t size)
 {
-    return channel.writeRequestHeader(body, buffer, size);
+    return channel.writeRequestHeader(body, headers, buffer, size);
 }
 
 #if LWS_LIBRARY_VERSION_NUMBER >= 2001000
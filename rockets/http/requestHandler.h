@@ -26,6 +26,7 @@
 #include <lws_config.h>
 
 #include <functional>
+#include <map>
 
 namespace rockets
 {
@@ -39,7 +40,8 @@ class RequestHandler
 public:
     RequestHandler(Channel&& channel, std::string body,
                    std::function<void(http::Response)> callback,
-                   std::function<void(std::string)> errorCallback);
+                   std::function<void(std::string)> errorCallback,
+                   std::map<std::string, std::string> headers = {});
 
     int writeHeaders(unsigned char** buffer, const size_t size);
 #if LWS_LIBRARY_VERSION_NUMBER >= 2001000
@@ -56,6 +58,7 @@ public:
 private:
     Channel channel;
     std::string body;
+    std::map<std::string, std::string> headers;
     std::function<void(Response)> callback;
     std::function<void(std::string)> errorCallback;
     Response response;
@@ -0,0 +1,114 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "responder.h"
+
+#include "connection.h"
+#include "responderState.h"
+
+namespace rockets
+{
+namespace http
+{
+ResponderState::ResponderState(Connection& connection, Post post,
+                               Encode encode, Offload offload)
+    : _connection{&connection}
+    , _post{std::move(post)}
+    , _encode{std::move(encode)}
+    , _offload{std::move(offload)}
+{
+}
+
+bool ResponderState::complete(Response response)
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_responding)
+            return false;
+        _responding = true;
+    }
+    auto self = shared_from_this();
+    auto finish = [self](Response encoded) {
+        self->_finish(std::move(encoded));
+    };
+    if (_offload && _offload(response, finish))
+        return true;
+
+    if (_encode)
+        _encode(response);
+    _finish(std::move(response));
+    return true;
+}
+
+bool ResponderState::isCompleted() const
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _completed;
+}
+
+Response ResponderState::takeResponse()
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    return std::move(_response);
+}
+
+void ResponderState::_finish(Response response)
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _response = std::move(response);
+        _completed = true;
+    }
+    if (_post)
+    {
+        auto self = shared_from_this();
+        _post([self] {
+            if (self->_connection)
+                self->_connection->requestWriteCallback();
+        });
+    }
+}
+
+/**
+ * Answers the request with an error if no response was given, once the last
+ * copy of the Responder is gone.
+ */
+class Responder::Impl
+{
+public:
+    explicit Impl(std::shared_ptr<ResponderState> state_)
+        : state{std::move(state_)}
+    {
+    }
+    ~Impl() { state->complete(Response{Code::INTERNAL_SERVER_ERROR}); }
+
+    std::shared_ptr<ResponderState> state;
+};
+
+Responder::Responder(std::shared_ptr<ResponderState> state)
+    : _impl{std::make_shared<Impl>(std::move(state))}
+{
+}
+
+bool Responder::respond(Response response) const
+{
+    return _impl->state->complete(std::move(response));
+}
+}
+}
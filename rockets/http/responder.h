@@ -0,0 +1,62 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_RESPONDER_H
+#define ROCKETS_HTTP_RESPONDER_H
+
+#include <rockets/api.h>
+#include <rockets/http/response.h>
+
+#include <memory>
+
+namespace rockets
+{
+namespace http
+{
+class ResponderState;
+
+/**
+ * Completes an HTTP request asynchronously, see Server::handleAsync().
+ *
+ * The thread serving the connection is woken up when the response is given,
+ * instead of waiting for it. Responders can be copied and used from any
+ * thread. If all copies are destroyed without responding, the request is
+ * answered with INTERNAL_SERVER_ERROR.
+ */
+class Responder
+{
+public:
+    /** @internal */
+    explicit Responder(std::shared_ptr<ResponderState> state);
+
+    /**
+     * Send the response to the request; only the first response is used.
+     *
+     * @return false if the request was already answered.
+     */
+    ROCKETS_API bool respond(Response response) const;
+
+private:
+    class Impl;
+    std::shared_ptr<Impl> _impl;
+};
+}
+}
+
+#endif
@@ -0,0 +1,101 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_RESPONDERSTATE_H
+#define ROCKETS_HTTP_RESPONDERSTATE_H
+
+#include <rockets/http/response.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace rockets
+{
+namespace http
+{
+class Connection;
+
+/**
+ * State shared by a Connection and the Responder completing its request.
+ *
+ * The response can be given from any thread. The connection is then woken up
+ * by posting a task to its service thread, which is also the only thread that
+ * detaches the connection when it closes.
+ */
+class ResponderState : public std::enable_shared_from_this<ResponderState>
+{
+public:
+    using Post = std::function<void(std::function<void()>)>;
+    using Encode = std::function<void(Response&)>;
+
+    /**
+     * Take over the encoding of a response to run it on another thread, which
+     * then gives the encoded response to the function passed along.
+     * @return false to encode it on the thread giving it instead.
+     */
+    using Offload =
+        std::function<bool(Response&, std::function<void(Response)>)>;
+
+    /**
+     * @param connection to wake up when the response is given.
+     * @param post function posting a task to the service thread of the
+     *        connection. If empty, the connection must poll isCompleted().
+     * @param encode optional function encoding the response, called from the
+     *        thread giving it unless offloaded.
+     * @param offload optional function encoding the response on another
+     *        thread instead.
+     */
+    ResponderState(Connection& connection, Post post, Encode encode = {},
+                   Offload offload = {});
+
+    /**
+     * Set the response (thread-safe), which completes once encoded.
+     * @return false if already set.
+     */
+    bool complete(Response response);
+
+    /** @return true if the response was given (thread-safe). */
+    bool isCompleted() const;
+
+    /** @return true if the connection gets woken up on completion. */
+    bool wakesUpConnection() const { return static_cast<bool>(_post); }
+
+    /** @return the response, once completed. */
+    Response takeResponse();
+
+    /** Called by the connection when it closes, from its service thread. */
+    void detach() { _connection = nullptr; }
+
+private:
+    mutable std::mutex _mutex;
+    bool _responding = false;
+    bool _completed = false;
+    Response _response;
+    Connection* _connection;
+    const Post _post;
+    const Encode _encode;
+    const Offload _offload;
+
+    void _finish(Response response);
+};
+}
+}
+
+#endif
@@ -23,8 +23,9 @@
 
 #include <rockets/http/types.h>
 
-#include <map>    // member
-#include <string> // member
+#include <functional> // member
+#include <map>        // member
+#include <string>     // member
 
 namespace rockets
 {
@@ -45,6 +46,22 @@ struct Response
     using Headers = std::map<Header, std::string>;
     Headers headers;
 
+    /**
+     * Producer for streaming the payload instead of returning it in body.
+     *
+     * It is called on the service thread each time the connection can accept
+     * more data, to copy at most size bytes to data. It returns the number of
+     * bytes copied, 0 to signal the end of the payload.
+     */
+    using BodyProducer = std::function<size_t(char* data, size_t size)>;
+    BodyProducer bodyProducer;
+
+    /**
+     * Size of the streamed payload, if known in advance. Otherwise the payload
+     * is sent with chunked transfer encoding.
+     */
+    size_t bodySize = 0;
+
     /** Construct a Response with a given return code and payload. */
     Response(const Code code_ = Code::OK, std::string body_ = std::string())
         : code{code_}
@@ -69,6 +86,26 @@ struct Response
         , headers{{std::move(headers_)}}
     {
     }
+
+    /**
+     * Construct a Response with a streamed payload.
+     *
+     * @param code_ HTTP return code.
+     * @param producer_ producer of the payload.
+     * @param size_ size of the payload, 0 if unknown.
+     * @param headers_ HTTP message headers.
+     */
+    Response(const Code code_, BodyProducer producer_, const size_t size_,
+             std::map<Header, std::string> headers_ = {})
+        : code{code_}
+        , headers{std::move(headers_)}
+        , bodyProducer{std::move(producer_)}
+        , bodySize{size_}
+    {
+    }
+
+    /** @return true if the payload is streamed by a bodyProducer. */
+    bool isStreamed() const { return static_cast<bool>(bodyProducer); }
 };
 }
 }
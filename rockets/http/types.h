@@ -23,6 +23,7 @@
 
 #include <functional>
 #include <future>
+#include <memory>
 
 namespace rockets
 {
@@ -30,7 +31,10 @@ namespace http
 {
 struct Request;
 struct Response;
+class BodySink;
 class Client;
+class Reply;
+class Responder;
 
 /** HTTP method used in a Request. */
 enum class Method
@@ -51,7 +55,10 @@ enum class Header
     CONTENT_TYPE,
     LAST_MODIFIED,
     LOCATION,
-    RETRY_AFTER
+    RETRY_AFTER,
+    ETAG,
+    CONTENT_ENCODING,
+    VARY
 };
 
 /** HTTP codes to be used in a Response. */
@@ -74,6 +81,7 @@ enum Code
     NOT_ACCEPTABLE = 406,
     REQUEST_TIMEOUT = 408,
     PRECONDITION_FAILED = 412,
+    PAYLOAD_TOO_LARGE = 413,
     UNSATISFIABLE_RANGE = 416,
     INTERNAL_SERVER_ERROR = 500,
     NOT_IMPLEMENTED = 501,
@@ -84,6 +92,54 @@ enum Code
 
 /** HTTP REST callback with Request parameter returning a Response future. */
 using RESTFunc = std::function<std::future<Response>(const Request&)>;
+
+/**
+ * HTTP REST callback with Request parameter returning a Reply, i.e. either a
+ * ready Response or a Response future. A RESTFunc converts to a ReplyFunc.
+ */
+using ReplyFunc = std::function<Reply(const Request&)>;
+
+/** HTTP REST callback with Request parameter, answering with the Responder. */
+using AsyncRESTFunc = std::function<void(const Request&, Responder)>;
+
+/** Factory of the BodySink receiving the payload of a new Request. */
+using BodySinkFactory =
+    std::function<std::unique_ptr<BodySink>(const Request&)>;
+
+/** Options for receiving the payload of the requests to an endpoint. */
+struct BodyOptions
+{
+    /** Maximum payload size, larger requests are rejected. 0 if unlimited. */
+    size_t maxSize = 0;
+
+    /**
+     * Payload size above which the payload is written to a temporary file
+     * instead of Request::body. 0 to always keep the payload in memory.
+     */
+    size_t spillSize = 0;
+};
+
+/** Options for compressing the payload of the responses. */
+struct CompressionOptions
+{
+    /** Compression level from 1 (fastest) to 9 (smallest), 0 to disable. */
+    int level = 6;
+
+    /** Payload size below which responses are sent uncompressed. */
+    size_t minSize = 1024;
+
+    /**
+     * Maximum number of compressed payloads of responses with an ETag kept
+     * for answering the next requests without compressing them again.
+     */
+    size_t cacheSize = 64;
+
+    /**
+     * Number of worker threads compressing the payloads off the service
+     * threads, 0 to compress them from the thread producing the response.
+     */
+    unsigned int threadCount = 1;
+};
 }
 }
 
@@ -0,0 +1,117 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "versionedContent.h"
+
+#include <ctime>
+#include <sstream>
+
+namespace rockets
+{
+namespace http
+{
+namespace
+{
+const std::string IF_MODIFIED_SINCE = "if-modified-since";
+const std::string IF_NONE_MATCH = "if-none-match";
+
+std::string _formatHttpDate(const std::time_t time)
+{
+    std::tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &time);
+#else
+    gmtime_r(&time, &tm);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buffer;
+}
+
+std::string _makeETag(const uint64_t version, const std::string& body)
+{
+    // the hash distinguishes versions of different processes
+    std::ostringstream etag;
+    etag << '"' << version << '-' << std::hex << std::hash<std::string>()(body)
+         << '"';
+    return etag.str();
+}
+
+bool _matches(const std::string& ifNoneMatch, const std::string& etag)
+{
+    return ifNoneMatch == "*" || ifNoneMatch.find(etag) != std::string::npos;
+}
+} // anonymous namespace
+
+struct VersionedContent::Entry
+{
+    uint64_t version;
+    std::string body;
+    std::string etag;
+    std::string lastModified;
+};
+
+VersionedContent::VersionedContent(Serializer serialize, VersionFunc getVersion,
+                                   std::string contentType)
+    : _serialize{std::move(serialize)}
+    , _getVersion{std::move(getVersion)}
+    , _contentType{std::move(contentType)}
+{
+}
+
+Response VersionedContent::respond(const Request& request) const
+{
+    const auto entry = _getEntry();
+    Response::Headers headers{{Header::ETAG, entry->etag},
+                              {Header::LAST_MODIFIED, entry->lastModified}};
+
+    const auto& requestHeaders = request.headers;
+    const auto ifNoneMatch = requestHeaders.find(IF_NONE_MATCH);
+    const auto ifModifiedSince = requestHeaders.find(IF_MODIFIED_SINCE);
+    const bool notModified =
+        ifNoneMatch != requestHeaders.end()
+            ? _matches(ifNoneMatch->second, entry->etag)
+            : ifModifiedSince != requestHeaders.end() &&
+                  ifModifiedSince->second == entry->lastModified;
+    if (notModified)
+        return Response{Code::NOT_MODIFIED, std::string(), std::move(headers)};
+
+    headers.emplace(Header::CONTENT_TYPE, _contentType);
+    return Response{Code::OK, entry->body, std::move(headers)};
+}
+
+VersionedContent::EntryPtr VersionedContent::_getEntry() const
+{
+    const auto version = _getVersion();
+    auto entry = std::atomic_load(&_entry);
+    if (entry && entry->version == version)
+        return entry;
+
+    // Concurrent requests may serialize the same new version more than once,
+    // but never wait for each other.
+    auto body = _serialize();
+    auto etag = _makeETag(version, body);
+    entry = std::make_shared<Entry>(Entry{version, std::move(body),
+                                          std::move(etag),
+                                          _formatHttpDate(std::time(nullptr))});
+    std::atomic_store(&_entry, entry);
+    return entry;
+}
+}
+}
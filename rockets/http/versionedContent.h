@@ -0,0 +1,82 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_HTTP_VERSIONEDCONTENT_H
+#define ROCKETS_HTTP_VERSIONEDCONTENT_H
+
+#include <rockets/api.h>
+#include <rockets/http/request.h>
+#include <rockets/http/response.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace rockets
+{
+namespace http
+{
+/**
+ * Content of a GET endpoint, serialized only once per version.
+ *
+ * The application increments the version each time the content changes. The
+ * serialized content is cached until then, and returned with an ETag and the
+ * time at which the version was first served as Last-Modified. Requests
+ * with a matching If-None-Match (or If-Modified-Since) are answered with
+ * NOT_MODIFIED, without serializing the content.
+ *
+ * Responses can be given from several threads concurrently.
+ */
+class VersionedContent
+{
+public:
+    /** @return the serialized content. */
+    using Serializer = std::function<std::string()>;
+
+    /** @return the current version of the content. */
+    using VersionFunc = std::function<uint64_t()>;
+
+    /**
+     * Create the cache of some content.
+     *
+     * @param serialize function serializing the content.
+     * @param getVersion function returning the version of the content.
+     * @param contentType of the serialized content.
+     */
+    ROCKETS_API VersionedContent(Serializer serialize, VersionFunc getVersion,
+                                 std::string contentType);
+
+    /** @return the response to a GET request for the content. */
+    ROCKETS_API Response respond(const Request& request) const;
+
+private:
+    struct Entry;
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    Serializer _serialize;
+    VersionFunc _getVersion;
+    std::string _contentType;
+    mutable EntryPtr _entry;
+
+    EntryPtr _getEntry() const;
+};
+}
+}
+
+#endif
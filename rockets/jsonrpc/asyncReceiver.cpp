@@ -45,6 +45,13 @@ void AsyncReceiver::bindAsync(const std::string& method,
                          });
 }
 
+void AsyncReceiver::bindAsyncJson(const std::string& method,
+                                  const DelayedJsonCallback& action)
+{
+    static_cast<AsyncReceiverImpl*>(_impl.get())
+        ->registerMethod(method, action);
+}
+
 std::future<std::string> AsyncReceiver::processAsync(const Request& request)
 {
     auto promise = std::make_shared<std::promise<std::string>>();
@@ -57,9 +64,10 @@ std::future<std::string> AsyncReceiver::processAsync(const Request& request)
 }
 
 void AsyncReceiver::process(const Request& request,
-                            AsyncStringResponse callback)
+                            AsyncStringResponse callback,
+                            const Encoding encoding)
 {
-    _impl->process(request, callback);
+    _impl->process(request, callback, encoding);
 }
 }
 }
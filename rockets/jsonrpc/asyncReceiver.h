@@ -47,6 +47,20 @@ public:
      */
     void bindAsync(const std::string& method, DelayedResponseCallback action);
 
+    /**
+     * Bind a method to an async callback operating on parsed JSON documents.
+     *
+     * Like Receiver::bindJson(), the parameters and the result do not go
+     * through an intermediate string. Requires including
+     * rockets/jsonrpc/jsonTypes.h.
+     *
+     * @param method to register.
+     * @param action to perform that will notify the caller upon completion.
+     * @throw std::invalid_argument if the method name starts with "rpc."
+     */
+    void bindAsyncJson(const std::string& method,
+                       const DelayedJsonCallback& action);
+
     /**
      * Bind a method to an async response callback with templated parameters.
      *
@@ -85,8 +99,10 @@ public:
      * @param request Request object with message in JSON-RPC 2.0 format.
      * @param callback that return a json response string in JSON-RPC 2.0
      *        format upon request completion.
+     * @param encoding of the request message, used for the response too.
      */
-    void process(const Request& request, AsyncStringResponse callback);
+    void process(const Request& request, AsyncStringResponse callback,
+                 Encoding encoding = Encoding::json);
 
 protected:
     AsyncReceiver(std::unique_ptr<RequestProcessor> impl);
@@ -31,36 +31,36 @@ public:
                         DelayedResponseCallback action)
     {
         verifyValidMethodName(method);
-        _methods[method] = action;
-    }
-
-    bool isRegisteredMethodName(const std::string& method) const override
-    {
-        return _methods.find(method) != _methods.end() ||
-               ReceiverImpl::isRegisteredMethodName(method);
+        addMethod(method, [action](const json& requestID,
+                                   const JsonRequest& request,
+                                   JsonResponseCallback respond) {
+            action(makeStringRequest(request),
+                   [respond, requestID](const Response rep) {
+                       // No reply for valid "notifications" (requests without
+                       // an "id")
+                       if (requestID.is_null())
+                           respond(json());
+                       else
+                           respond(makeResponse(rep, requestID));
+                   });
+        });
     }
 
-    void process(const json& requestID, const std::string& method,
-                 const Request& request, JsonResponseCallback respond) override
+    void registerMethod(const std::string& method, DelayedJsonCallback action)
     {
-        if (_methods.find(method) == _methods.end())
-        {
-            ReceiverImpl::process(requestID, method, request, respond);
-            return;
-        }
-
-        const auto& func = _methods[method];
-        func(request, [respond, requestID](const Response rep) {
-            // No reply for valid "notifications" (requests without an "id")
-            if (requestID.is_null())
-                respond(json());
-            else
-                respond(makeResponse(rep, requestID));
+        verifyValidMethodName(method);
+        addMethod(method, [action](const json& requestID,
+                                   const JsonRequest& request,
+                                   JsonResponseCallback respond) {
+            action(request, [respond, requestID](JsonResponse rep) {
+                // No reply for valid "notifications" (requests without an "id")
+                if (requestID.is_null())
+                    respond(json());
+                else
+                    respond(makeResponse(std::move(rep), requestID));
+            });
         });
     }
-
-private:
-    std::map<std::string, DelayedResponseCallback> _methods;
 };
 }
 }
@@ -41,5 +41,12 @@ void CancellableReceiver::bindAsync(const std::string& method,
                              return action(request, response, progress);
                          });
 }
+
+void CancellableReceiver::bindAsyncJson(const std::string& method,
+                                        const CancellableJsonCallback& action)
+{
+    static_cast<CancellableReceiverImpl*>(_impl.get())
+        ->registerMethod(method, action);
+}
 }
 }
@@ -71,6 +71,22 @@ public:
     void bindAsync(const std::string& method,
                    CancellableResponseCallback action);
 
+    /**
+     * Bind a cancellable method to an async callback operating on parsed JSON
+     * documents.
+     *
+     * Like Receiver::bindJson(), the parameters and the result do not go
+     * through an intermediate string. Requires including
+     * rockets/jsonrpc/jsonTypes.h.
+     *
+     * @param method to register.
+     * @param action to perform that will notify the caller upon completion.
+     * @throw std::invalid_argument if the method name starts with "rpc." or
+     *                              "cancel"
+     */
+    void bindAsyncJson(const std::string& method,
+                       const CancellableJsonCallback& action);
+
     /**
      * Bind a cancellable method to an async response callback with templated
      * parameters.
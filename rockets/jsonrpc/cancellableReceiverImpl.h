@@ -43,13 +43,44 @@ public:
     CancellableReceiverImpl(SendTextCallback sendTextCb)
         : _sendTextCb(sendTextCb)
     {
+        addMethod(cancelMethodName,
+                  [this](const json& requestID, const JsonRequest& request,
+                         JsonResponseCallback respond) {
+                      processCancel(requestID, request);
+                      respond(json());
+                  });
     }
 
     void registerMethod(const std::string& method,
                         CancellableResponseCallback action)
     {
         verifyValidMethodName(method);
-        _methods[method] = action;
+        addMethod(method, [this, action](const json& requestID,
+                                         const JsonRequest& request,
+                                         JsonResponseCallback respond) {
+            _process<Response>(
+                [&action, &request](AsyncResponse done,
+                                    ProgressUpdateCallback progress) {
+                    return action(makeStringRequest(request), done, progress);
+                },
+                requestID, request, respond);
+        });
+    }
+
+    void registerMethod(const std::string& method,
+                        CancellableJsonCallback action)
+    {
+        verifyValidMethodName(method);
+        addMethod(method, [this, action](const json& requestID,
+                                         const JsonRequest& request,
+                                         JsonResponseCallback respond) {
+            _process<JsonResponse>(
+                [&action, &request](AsyncJsonResponse done,
+                                    ProgressUpdateCallback progress) {
+                    return action(request, done, progress);
+                },
+                requestID, request, respond);
+        });
     }
 
     void verifyValidMethodName(const std::string& method) const final
@@ -62,29 +93,51 @@ public:
         AsyncReceiverImpl::verifyValidMethodName(method);
     }
 
-    bool isRegisteredMethodName(const std::string& method) const override
+    void processCancel(const json& id, const JsonRequest& request)
     {
-        return _methods.find(method) != _methods.end() ||
-               method == cancelMethodName ||
-               AsyncReceiverImpl::isRegisteredMethodName(method);
-    }
+        const auto& params = request.params;
 
-    void process(const json& requestID, const std::string& method,
-                 const Request& request, JsonResponseCallback respond) override
-    {
-        if (method == cancelMethodName)
-        {
-            processCancel(requestID, request);
-            respond(json());
+        // need a valid notification with the ID of the request to cancel
+        const bool isNotification = id.is_null();
+        if (!isNotification || !params.is_object() || !params.count("id"))
             return;
-        }
 
-        if (_methods.find(method) == _methods.end())
-        {
-            AsyncReceiverImpl::process(requestID, method, request, respond);
+        std::lock_guard<std::mutex> lock(pendingRequests->mutex);
+
+        // invalid request ID or request already processed
+        const auto requestID = params["id"];
+        auto& pendingRequest = pendingRequests->requests;
+        auto cancelFunc = pendingRequest.find(requestID);
+        if (cancelFunc == pendingRequest.end())
             return;
-        }
 
+        // cancel callback to the application. The response from the application
+        // has to be a callback in case the cancel processing is blocking.
+        cancelFunc->second.first(
+            [ respond = cancelFunc->second.second, requestID ] {
+                respond(makeErrorResponse(requestAborted, requestID));
+            });
+
+        pendingRequest.erase(requestID);
+    }
+
+private:
+    SendTextCallback _sendTextCb;
+
+    struct PendingRequests
+    {
+        std::mutex mutex;
+        std::map<json, std::pair<CancelRequestCallback, JsonResponseCallback>>
+            requests;
+    };
+
+    std::shared_ptr<PendingRequests> pendingRequests{
+        std::make_shared<PendingRequests>()};
+
+    template <typename Rep, typename Action>
+    void _process(const Action& action, const json& requestID,
+                  const JsonRequest& request, JsonResponseCallback respond)
+    {
         // temporary entry for the request is needed in case the action has an
         // early error, so skipResponse() works properly
         {
@@ -119,28 +172,28 @@ public:
               &sendText = _sendTextCb ](const std::string& msg,
                                         const float amount)
         {
-            json progress{{"id", requestID},
-                          {"amount", amount},
-                          {"operation", msg}};
-            sendText(makeNotification(progressMethodName, progress.dump()),
-                     clientID);
+            const json progress{{"jsonrpc", "2.0"},
+                                {"method", progressMethodName},
+                                {"params",
+                                 {{"id", requestID},
+                                  {"amount", amount},
+                                  {"operation", msg}}}};
+            sendText(progress.dump(), clientID);
         };
 
-        const auto& func = _methods[method];
         auto cancelFunc =
-            func(request,
-                 [respond, requestID, skipResponse](const Response rep) {
-                     if (skipResponse())
-                         return;
-
-                     // No reply for valid "notifications" (requests without an
-                     // "id")
-                     if (requestID.is_null())
-                         respond(json());
-                     else
-                         respond(makeResponse(rep, requestID));
-                 },
-                 progressFunc);
+            action([respond, requestID, skipResponse](Rep rep) {
+                       if (skipResponse())
+                           return;
+
+                       // No reply for valid "notifications" (requests without
+                       // an "id")
+                       if (requestID.is_null())
+                           respond(json());
+                       else
+                           respond(makeResponse(std::move(rep), requestID));
+                   },
+                   progressFunc);
 
         if (cancelFunc)
         {
@@ -148,49 +201,6 @@ public:
             pendingRequests->requests[requestID].first = cancelFunc;
         }
     }
-
-    void processCancel(const json& id, const Request& request)
-    {
-        auto params = json::parse(request.message, nullptr, false);
-
-        // need a valid notification with the ID of the request to cancel
-        const bool isNotification = id.is_null();
-        if (!isNotification || !params.count("id"))
-            return;
-
-        std::lock_guard<std::mutex> lock(pendingRequests->mutex);
-
-        // invalid request ID or request already processed
-        const auto requestID = params["id"];
-        auto& pendingRequest = pendingRequests->requests;
-        auto cancelFunc = pendingRequest.find(requestID);
-        if (cancelFunc == pendingRequest.end())
-            return;
-
-        // cancel callback to the application. The response from the application
-        // has to be a callback in case the cancel processing is blocking.
-        cancelFunc->second.first(
-            [ respond = cancelFunc->second.second, requestID ] {
-                respond(makeErrorResponse(requestAborted, requestID));
-            });
-
-        pendingRequest.erase(requestID);
-    }
-
-private:
-    SendTextCallback _sendTextCb;
-
-    std::map<std::string, CancellableResponseCallback> _methods;
-
-    struct PendingRequests
-    {
-        std::mutex mutex;
-        std::map<json, std::pair<CancelRequestCallback, JsonResponseCallback>>
-            requests;
-    };
-
-    std::shared_ptr<PendingRequests> pendingRequests{
-        std::make_shared<PendingRequests>()};
 };
 }
 }
@@ -62,15 +62,69 @@ public:
             });
     }
 
+    /**
+     * Indent the JSON messages for debugging.
+     *
+     * @param pretty true to indent, false for compact messages (default).
+     */
+    void setPrettyPrint(const bool pretty)
+    {
+        _prettyPrint = pretty;
+        Receiver::setPrettyPrint(pretty);
+    }
+
+    /**
+     * Send the requests and notifications in a binary encoding.
+     *
+     * The server must accept the same encoding, which the communicator
+     * selects by connecting with the websocket protocol "<name>.msgpack" or
+     * "<name>.cbor" (see Server::setBinaryEncoding()). The server replies in
+     * the encoding of each request. This requires the communicator to also
+     * provide:
+     *
+     * - void sendBinary(const char* data, size_t size);
+     *   Used to send notifications and requests to the server.
+     *
+     * - void handleBinary(ws::MessageCallback callback);
+     *   Used to register a callback for processing the responses.
+     *
+     * @param encoding of the messages, Encoding::json for text messages.
+     */
+    void setEncoding(const Encoding encoding)
+    {
+        _encoding = encoding;
+        if (encoding == Encoding::json)
+        {
+            _sendBinary = nullptr;
+            return;
+        }
+
+        auto& comm = communicator;
+        _sendBinary = [&comm](const std::string& message) {
+            comm.sendBinary(message.data(), message.size());
+        };
+        communicator.handleBinary(
+            [ this, encoding, thisStatus = std::weak_ptr<bool>{status} ](
+                const Request& request_) {
+                if (!thisStatus.expired())
+                    processResponse(request_.message, encoding);
+                return std::string();
+            });
+    }
+
 private:
     /** Notifier::_send */
     void _send(std::string json) final
     {
-        communicator.sendText(std::move(json));
+        if (_sendBinary)
+            _sendBinary(json);
+        else
+            communicator.sendText(std::move(json));
     }
 
     void _processNotification(const Request& request_) { process(request_); }
     Communicator& communicator;
+    std::function<void(const std::string&)> _sendBinary;
     std::shared_ptr<bool> status = std::make_shared<bool>(true);
 };
 }
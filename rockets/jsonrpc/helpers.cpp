@@ -19,17 +19,25 @@
 
 #include "helpers.h"
 
-#include "../json.hpp"
-
-using namespace rockets_nlohmann;
+#include "utils.h"
 
 namespace rockets
 {
 namespace jsonrpc
 {
+namespace
+{
+bool _endsWith(const std::string& string, const std::string& suffix)
+{
+    return string.size() >= suffix.size() &&
+           string.compare(string.size() - suffix.size(), suffix.size(),
+                          suffix) == 0;
+}
+}
+
 std::string makeNotification(const std::string& method)
 {
-    return json{{"jsonrpc", "2.0"}, {"method", method}}.dump(4);
+    return json{{"jsonrpc", "2.0"}, {"method", method}}.dump();
 }
 
 std::string makeNotification(const std::string& method,
@@ -38,7 +46,27 @@ std::string makeNotification(const std::string& method,
     return json{{"jsonrpc", "2.0"},
                 {"method", method},
                 {"params", json::parse(params)}}
-        .dump(4);
+        .dump();
+}
+
+std::string makeNotification(const std::string& method,
+                             const std::string& params,
+                             const Encoding encoding, const bool pretty)
+{
+    json notification{{"jsonrpc", "2.0"}, {"method", method}};
+    if (!params.empty())
+        notification["params"] = json::parse(params);
+    return encode(notification, encoding, pretty);
+}
+
+Encoding getBinaryEncoding(const std::string& protocol,
+                           const Encoding fallback)
+{
+    if (_endsWith(protocol, ".msgpack"))
+        return Encoding::msgpack;
+    if (_endsWith(protocol, ".cbor"))
+        return Encoding::cbor;
+    return fallback;
 }
 }
 }
@@ -20,6 +20,8 @@
 #ifndef ROCKETS_JSONRPC_HELPERS_H
 #define ROCKETS_JSONRPC_HELPERS_H
 
+#include <rockets/jsonrpc/types.h>
+
 #include <string>
 
 namespace rockets
@@ -33,6 +35,24 @@ std::string makeNotification(const std::string& method);
 std::string makeNotification(const std::string& method,
                              const std::string& params);
 
+/**
+ * @param method of the notification.
+ * @param params of the notification in JSON format, empty if none.
+ * @param encoding of the notification message.
+ * @param pretty indent the message if it is in Encoding::json.
+ * @return the notification message.
+ */
+std::string makeNotification(const std::string& method,
+                             const std::string& params, Encoding encoding,
+                             bool pretty = false);
+
+/**
+ * @return the encoding of the binary messages selected by a websocket
+ *         protocol named "<name>.msgpack" or "<name>.cbor", or the fallback
+ *         encoding for any other protocol.
+ */
+Encoding getBinaryEncoding(const std::string& protocol, Encoding fallback);
+
 /**
  * @return a JSON RPC notification for the given method and templated
  *         params.
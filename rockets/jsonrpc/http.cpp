@@ -36,7 +36,7 @@ std::string makeJsonHttpError(const std::string& errorMsg, const json& id)
                 {"error",
                  json{{"message", errorMsg}, {"code", ErrorCode::http_error}}},
                 {"id", id}}
-        .dump(4);
+        .dump();
 }
 }
 
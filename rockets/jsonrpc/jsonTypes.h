@@ -0,0 +1,110 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_JSONRPC_JSON_TYPES_H
+#define ROCKETS_JSONRPC_JSON_TYPES_H
+
+#include <rockets/jsonrpc/types.h>
+
+#include "../json.hpp"
+
+namespace rockets
+{
+namespace jsonrpc
+{
+using json = rockets_nlohmann::json;
+
+/**
+ * A request with its parameters as parsed by the receiver.
+ */
+struct JsonRequest
+{
+    /** The 'params' of the request, null if it has none. */
+    const json& params;
+
+    /** The ID of the client which sent the request. */
+    const uintptr_t clientID;
+};
+
+/**
+ * Callback receiving the parsed parameters of a request and returning its
+ * result as a JSON document.
+ *
+ * Neither the parameters nor the result go through an intermediate string,
+ * so they are only parsed and serialized once, as part of the messages. The
+ * callback can throw a response_error to reply with an error.
+ */
+struct JsonCallback : public std::function<json(const JsonRequest&)>
+{
+    using std::function<json(const JsonRequest&)>::function;
+};
+
+/**
+ * Response to an asynchronous request, either its result as a JSON document or
+ * an error.
+ */
+struct JsonResponse
+{
+    json result;
+    Response::Error error;
+
+    /** Construct a successful response. */
+    JsonResponse(json res)
+        : result(std::move(res))
+    {
+    }
+
+    /** Construct an error response. */
+    JsonResponse(Response::Error&& err)
+        : error(std::move(err))
+    {
+    }
+
+    bool isError() const { return error.code != 0; }
+};
+
+using AsyncJsonResponse = std::function<void(JsonResponse)>;
+
+/**
+ * Callback receiving the parsed parameters of a request and responding with a
+ * JSON document, possibly later. The request is only valid during the call.
+ */
+struct DelayedJsonCallback
+    : public std::function<void(const JsonRequest&, AsyncJsonResponse)>
+{
+    using std::function<void(const JsonRequest&, AsyncJsonResponse)>::function;
+};
+
+/**
+ * Callback receiving the parsed parameters of a cancellable request and
+ * responding with a JSON document, possibly later. The request is only valid
+ * during the call.
+ */
+struct CancellableJsonCallback
+    : public std::function<CancelRequestCallback(
+          const JsonRequest&, AsyncJsonResponse, ProgressUpdateCallback)>
+{
+    using std::function<CancelRequestCallback(
+        const JsonRequest&, AsyncJsonResponse,
+        ProgressUpdateCallback)>::function;
+};
+}
+}
+
+#endif
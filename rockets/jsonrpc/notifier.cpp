@@ -27,8 +27,7 @@ namespace jsonrpc
 {
 void Notifier::notify(const std::string& method, const std::string& params)
 {
-    _send(params.empty() ? makeNotification(method)
-                         : makeNotification(method, params));
+    _send(makeNotification(method, params, _encoding, _prettyPrint));
 }
 }
 }
@@ -20,6 +20,8 @@
 #ifndef ROCKETS_JSONRPC_NOTIFIER_H
 #define ROCKETS_JSONRPC_NOTIFIER_H
 
+#include <rockets/jsonrpc/types.h>
+
 #include <string>
 
 namespace rockets
@@ -56,6 +58,12 @@ public:
 
 protected:
     virtual void _send(std::string json) = 0;
+
+    /** The encoding of the emitted messages. */
+    Encoding _encoding = Encoding::json;
+
+    /** Indent the emitted messages in Encoding::json, for debugging. */
+    bool _prettyPrint = false;
 };
 }
 }
@@ -0,0 +1,158 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "publisher.h"
+
+#include "utils.h"
+
+#include <map>
+#include <mutex>
+
+namespace rockets
+{
+namespace jsonrpc
+{
+namespace
+{
+const std::string patchSuffix = ".patch";
+
+struct Object
+{
+    Publisher::Serializer serialize;
+    std::mutex mutex;
+
+    // last state sent to the subscribers, outdated if there are none
+    bool upToDate = false;
+    json state;
+
+    std::set<uintptr_t> subscribers;
+
+    /** @return the current state, serialized and parsed. */
+    json read() const
+    {
+        try
+        {
+            return json::parse(serialize());
+        }
+        catch (const json::parse_error& e)
+        {
+            throw std::invalid_argument(e.what());
+        }
+    }
+};
+}
+
+class Publisher::Impl
+{
+public:
+    Impl(MulticastTextCallback sendText_)
+        : sendText{std::move(sendText_)}
+    {
+    }
+
+    Object* find(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        const auto it = objects.find(name);
+        return it == objects.end() ? nullptr : it->second.get();
+    }
+
+    MulticastTextCallback sendText;
+
+    // objects are never removed, the pointers remain valid
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<Object>> objects;
+};
+
+Publisher::Publisher(MulticastTextCallback sendText)
+    : _impl{new Impl(std::move(sendText))}
+{
+}
+
+Publisher::~Publisher() = default;
+
+void Publisher::add(const std::string& name, Serializer serialize)
+{
+    std::lock_guard<std::mutex> lock{_impl->mutex};
+    auto& object = _impl->objects[name];
+    if (object)
+        throw std::invalid_argument("object already published: " + name);
+    object.reset(new Object);
+    object->serialize = std::move(serialize);
+}
+
+bool Publisher::subscribe(const std::string& name, const uintptr_t client,
+                          const AsyncJsonResponse& respond)
+{
+    auto object = _impl->find(name);
+    if (!object)
+        return false;
+
+    std::lock_guard<std::mutex> lock{object->mutex};
+    if (!object->upToDate)
+    {
+        object->state = object->read();
+        object->upToDate = true;
+    }
+    object->subscribers.insert(client);
+
+    // under lock: the state must reach the client before the next patch
+    respond(object->state);
+    return true;
+}
+
+bool Publisher::unsubscribe(const std::string& name, const uintptr_t client)
+{
+    auto object = _impl->find(name);
+    if (!object)
+        return false;
+
+    std::lock_guard<std::mutex> lock{object->mutex};
+    return object->subscribers.erase(client) > 0;
+}
+
+bool Publisher::publish(const std::string& name)
+{
+    auto object = _impl->find(name);
+    if (!object)
+        return false;
+
+    std::lock_guard<std::mutex> lock{object->mutex};
+    if (object->subscribers.empty())
+    {
+        // serialize only once someone subscribes
+        object->upToDate = false;
+        return true;
+    }
+
+    auto state = object->read();
+    auto patch = json::diff(object->state, state);
+    object->state = std::move(state);
+    if (patch.empty())
+        return true;
+
+    const json notification{{"jsonrpc", "2.0"},
+                            {"method", name + patchSuffix},
+                            {"params", std::move(patch)}};
+    object->subscribers =
+        _impl->sendText(notification.dump(), object->subscribers);
+    return true;
+}
+}
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_JSONRPC_PUBLISHER_H
+#define ROCKETS_JSONRPC_PUBLISHER_H
+
+#include <rockets/jsonrpc/jsonTypes.h>
+
+#include <memory>
+#include <set>
+
+namespace rockets
+{
+namespace jsonrpc
+{
+/**
+ * Publisher of the state of objects to subscribed clients.
+ *
+ * A new subscriber receives the last published state of the object, then a
+ * "<name>.patch" notification with the RFC 6902 JSON Patch from one state to
+ * the next for each publish(). The patch is computed and serialized once per
+ * change and the same message is sent to all subscribers.
+ */
+class Publisher
+{
+public:
+    /** @return the JSON state of an object. */
+    using Serializer = std::function<std::string()>;
+
+    /**
+     * Send a message to several clients.
+     * @return the clients which are still connected.
+     */
+    using MulticastTextCallback = std::function<std::set<uintptr_t>(
+        const std::string&, const std::set<uintptr_t>&)>;
+
+    explicit Publisher(MulticastTextCallback sendText);
+    ~Publisher();
+
+    /**
+     * Add an object which clients can subscribe to.
+     *
+     * @throw std::invalid_argument if an object with the same name exists.
+     */
+    void add(const std::string& name, Serializer serialize);
+
+    /**
+     * Subscribe a client to an object.
+     *
+     * @param name of the object.
+     * @param client to subscribe.
+     * @param respond callback receiving the current state of the object as a
+     *        parsed document, called before any subsequent patch is sent.
+     * @return false if there is no such object.
+     */
+    bool subscribe(const std::string& name, uintptr_t client,
+                   const AsyncJsonResponse& respond);
+
+    /** @return false if the client was not subscribed to the object. */
+    bool unsubscribe(const std::string& name, uintptr_t client);
+
+    /**
+     * Send the changes of an object since the last publication to its
+     * subscribers.
+     *
+     * @return false if there is no such object.
+     * @throw std::invalid_argument if the object state is not valid JSON.
+     */
+    bool publish(const std::string& name);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+}
+
+#endif
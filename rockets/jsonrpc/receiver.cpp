@@ -21,10 +21,23 @@
 #include "receiverImpl.h"
 #include "utils.h"
 
+#include "../workerPool.h"
+
+#include <future>
+
 namespace rockets
 {
 namespace jsonrpc
 {
+namespace
+{
+bool _isBatch(const std::string& message)
+{
+    const auto begin = message.find_first_not_of(" \t\n\r");
+    return begin != std::string::npos && message[begin] == '[';
+}
+}
+
 Receiver::Receiver()
     : _impl{std::make_unique<ReceiverImpl>()}
 {
@@ -60,13 +73,43 @@ void Receiver::bind(const std::string& method, ResponseCallback action)
     static_cast<ReceiverImpl*>(_impl.get())->registerMethod(method, action);
 }
 
+void Receiver::bindJson(const std::string& method, const JsonCallback& action)
+{
+    static_cast<ReceiverImpl*>(_impl.get())->registerMethod(method, action);
+}
+
 std::string Receiver::process(const Request& request)
 {
-    std::string result;
-    _impl->process(request, [&result](std::string result_) {
-        result = std::move(result_);
+    // the promise is shared with the callback, which may be called later for
+    // asynchronous methods and from a worker thread for batch requests
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    _impl->process(request, [promise](std::string result) {
+        promise->set_value(std::move(result));
     });
-    return result;
+
+    if (_batchExecutor && _isBatch(request.message))
+        return future.get();
+
+    const auto status = future.wait_for(std::chrono::seconds(0));
+    return status == std::future_status::ready ? future.get() : std::string();
+}
+
+void Receiver::setPrettyPrint(const bool pretty)
+{
+    _impl->setPrettyPrint(pretty);
+}
+
+void Receiver::setBatchThreadCount(const unsigned int threadCount,
+                                   const size_t maxQueueSize)
+{
+    _impl->setBatchExecutor(nullptr);
+    _batchExecutor.reset();
+    if (threadCount == 0)
+        return;
+
+    _batchExecutor = std::make_unique<WorkerPool>(threadCount, maxQueueSize);
+    _impl->setBatchExecutor(_batchExecutor.get());
 }
 }
 }
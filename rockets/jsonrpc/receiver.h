@@ -27,6 +27,8 @@
 
 namespace rockets
 {
+class WorkerPool;
+
 namespace jsonrpc
 {
 /**
@@ -97,6 +99,19 @@ public:
      */
     void bind(const std::string& method, ResponseCallback action);
 
+    /**
+     * Bind a method to a callback operating on parsed JSON documents.
+     *
+     * This avoids serializing the parameters to a string and parsing them
+     * again, and the same for the result. Requires including
+     * rockets/jsonrpc/jsonTypes.h.
+     *
+     * @param method to register.
+     * @param action to perform.
+     * @throw std::invalid_argument if the method name starts with "rpc."
+     */
+    void bindJson(const std::string& method, const JsonCallback& action);
+
     /**
      * Bind a method to a response callback with templated request parameters.
      *
@@ -179,14 +194,51 @@ public:
     /**
      * Process a JSON-RPC request and block for the result.
      *
+     * Asynchronous methods which respond later are not waited for, unless
+     * called from a batch processed by worker threads (see
+     * setBatchThreadCount()).
+     *
      * @param request Request object with message in JSON-RPC 2.0 format.
-     * @return json response string in JSON-RPC 2.0 format.
+     * @return json response string in JSON-RPC 2.0 format, empty if not given
+     *         during the call.
      */
     std::string process(const Request& request);
 
+    /**
+     * Indent the JSON responses for debugging.
+     *
+     * @param pretty true to indent, false for compact responses (default).
+     */
+    void setPrettyPrint(bool pretty);
+
+    /**
+     * Process the entries of batch requests in parallel on worker threads.
+     *
+     * The entries of a batch are always dispatched without waiting for each
+     * other, and the response is sent once all of them have completed. By
+     * default, they are processed by the thread which receives the batch.
+     *
+     * Once enabled, the bound methods are called concurrently by the worker
+     * threads and by the thread receiving the requests, so they must all be
+     * thread-safe. This is the case even if the requests come from the
+     * callbacks of a rockets::Server, which are otherwise never called
+     * concurrently.
+     *
+     * Must be called before processing any request.
+     *
+     * @param threadCount the number of worker threads, 0 to disable.
+     * @param maxQueueSize the maximum number of entries waiting for a worker,
+     *        above which entries are processed by the receiving thread.
+     */
+    void setBatchThreadCount(unsigned int threadCount,
+                             size_t maxQueueSize = 1024);
+
 protected:
     Receiver(std::unique_ptr<RequestProcessor> impl);
     std::unique_ptr<RequestProcessor> _impl;
+
+private:
+    std::unique_ptr<WorkerPool> _batchExecutor; // must be destructed first
 };
 }
 }
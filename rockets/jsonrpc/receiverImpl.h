@@ -18,6 +18,7 @@
  */
 
 #include "requestProcessor.h"
+#include "responseError.h"
 #include "utils.h"
 
 namespace rockets
@@ -30,26 +31,38 @@ public:
     void registerMethod(const std::string& method, ResponseCallback action)
     {
         verifyValidMethodName(method);
-        _methods[method] = action;
+        addMethod(method, [action](const json& requestID,
+                                   const JsonRequest& request,
+                                   JsonResponseCallback respond) {
+            const auto response = action(makeStringRequest(request));
+            // No reply for valid "notifications" (requests without an "id")
+            if (requestID.is_null())
+                respond(json());
+            else
+                respond(makeResponse(response, requestID));
+        });
     }
 
-    bool isRegisteredMethodName(const std::string& method) const override
+    void registerMethod(const std::string& method, JsonCallback action)
     {
-        return _methods.find(method) != _methods.end();
-    }
-
-    void process(const json& requestID, const std::string& method,
-                 const Request& request, JsonResponseCallback respond) override
-    {
-        auto response = _methods[method](request);
-        if (requestID.is_null())
-            respond(json());
-        else
-            respond(makeResponse(response, requestID));
+        verifyValidMethodName(method);
+        addMethod(method, [action](const json& requestID,
+                                   const JsonRequest& request,
+                                   JsonResponseCallback respond) {
+            json response;
+            try
+            {
+                response = makeResponse(action(request), requestID);
+            }
+            catch (const response_error& e)
+            {
+                response = makeErrorResponse(Response::Error{e.what(), e.code},
+                                             requestID);
+            }
+            // No reply for valid "notifications" (requests without an "id")
+            respond(requestID.is_null() ? json() : std::move(response));
+        });
     }
-
-private:
-    std::map<std::string, ResponseCallback> _methods;
 };
 }
 }
@@ -20,7 +20,9 @@
 #include "requestProcessor.h"
 #include "utils.h"
 
-#include <future>
+#include "../workerPool.h"
+
+#include <mutex>
 
 namespace rockets
 {
@@ -52,34 +54,86 @@ bool _isValidJsonRpcRequest(const json& object)
             object["id"].is_string());
 }
 
-inline std::string dump(const json& object)
+inline std::string dump(const json& object, const Encoding encoding,
+                        const bool pretty)
 {
-    return object.is_null() ? "" : object.dump(4);
+    return object.is_null() ? "" : encode(object, encoding, pretty);
 }
 
+/**
+ * Responses of the entries of a batch request, which are collected in order
+ * and replied at once when the last entry completes. Only the first response
+ * of each entry is kept.
+ */
+class BatchResponse
+{
+public:
+    BatchResponse(const size_t size, std::function<void(json)> respond)
+        : _responses(size)
+        , _completed(size, false)
+        , _pending(size)
+        , _respond(std::move(respond))
+    {
+    }
+
+    void set(const size_t index, json response)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_completed[index])
+                return;
+            _completed[index] = true;
+            _responses[index] = std::move(response);
+            if (--_pending > 0)
+                return;
+        }
+
+        // No reply if the batch only contains notifications
+        json responses;
+        for (auto& entry : _responses)
+        {
+            if (!entry.is_null())
+                responses.push_back(std::move(entry));
+        }
+        _respond(std::move(responses));
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<json> _responses;
+    std::vector<bool> _completed;
+    size_t _pending;
+    std::function<void(json)> _respond;
+};
+
 } // anonymous namespace
 
 void RequestProcessor::process(const Request& request,
-                               AsyncStringResponse callback)
+                               AsyncStringResponse callback,
+                               const Encoding encoding)
 {
     try
     {
-        const auto document = json::parse(request.message);
+        auto document = decode(request.message, encoding);
+        auto stringifyCallback = [ callback, encoding,
+                                   pretty = _prettyPrint ](const json obj) {
+            callback(dump(obj, encoding, pretty));
+        };
         if (document.is_object())
-        {
-            auto stringifyCallback = [callback](const json obj) {
-                callback(dump(obj));
-            };
             _processCommand(document, request.clientID, stringifyCallback);
-        }
         else if (document.is_array())
-            callback(_processBatchBlocking(document, request.clientID));
+        {
+            _processBatch(std::move(document), request.clientID,
+                          stringifyCallback);
+        }
         else
-            callback(dump(makeErrorResponse(invalidParams)));
+            callback(dump(makeErrorResponse(invalidParams), encoding,
+                          _prettyPrint));
     }
     catch (const json::parse_error& e)
     {
-        callback(dump(makeErrorResponse(parseError, json(), e.what())));
+        callback(dump(makeErrorResponse(parseError, json(), e.what()),
+                      encoding, _prettyPrint));
     }
 }
 
@@ -89,42 +143,53 @@ void RequestProcessor::verifyValidMethodName(const std::string& method) const
         throw std::invalid_argument(reservedMethodError);
 }
 
-std::string RequestProcessor::_processBatchBlocking(const json& array,
-                                                    const uintptr_t clientID)
+void RequestProcessor::addMethod(const std::string& name, Method method)
 {
-    if (array.empty())
-        return "";
-    return dump(_processValidBatchBlocking(array, clientID));
+    _methods[name] = std::move(method);
 }
 
-json RequestProcessor::_processValidBatchBlocking(const json& array,
-                                                  const uintptr_t clientID)
+void RequestProcessor::_processBatch(json array, const uintptr_t clientID,
+                                     JsonResponseCallback respond)
 {
-    json responses;
-    for (const auto& entry : array)
+    if (array.empty())
     {
-        if (entry.is_object())
-        {
-            const auto response = _processCommandBlocking(entry, clientID);
-            if (!response.is_null())
-                responses.push_back(response);
-        }
-        else
-            responses.push_back(makeErrorResponse(invalidRequest));
+        respond(json());
+        return;
     }
-    return responses;
-}
 
-json RequestProcessor::_processCommandBlocking(const json& request,
-                                               const uintptr_t clientID)
-{
-    auto promise = std::make_shared<std::promise<json>>();
-    auto future = promise->get_future();
-    auto callback = [promise](json response) {
-        promise->set_value(std::move(response));
-    };
-    _processCommand(request, clientID, callback);
-    return future.get();
+    // The entries are all dispatched without waiting for the previous ones to
+    // complete, so that async methods never block the calling thread.
+    const auto entries = std::make_shared<const json>(std::move(array));
+    const auto batch =
+        std::make_shared<BatchResponse>(entries->size(), std::move(respond));
+    for (size_t i = 0; i < entries->size(); ++i)
+    {
+        auto task = [this, entries, batch, i, clientID] {
+            auto done = [batch, i](json response) {
+                batch->set(i, std::move(response));
+            };
+            const auto& entry = (*entries)[i];
+            if (!entry.is_object())
+            {
+                done(makeErrorResponse(invalidRequest));
+                return;
+            }
+            // the entry may be processed by a worker thread, which must not
+            // let the exceptions of the method escape
+            try
+            {
+                _processCommand(entry, clientID, done);
+            }
+            catch (...)
+            {
+                const auto id = entry.count("id") ? entry["id"] : json();
+                done(id.is_null() ? json()
+                                  : makeErrorResponse(internalError, id));
+            }
+        };
+        if (!_batchExecutor || !_batchExecutor->post(task))
+            task();
+    }
 }
 
 void RequestProcessor::_processCommand(const json& request,
@@ -142,8 +207,9 @@ void RequestProcessor::_processCommand(const json& request,
         return;
     }
 
-    const auto methodName = request["method"].get<std::string>();
-    if (!isRegisteredMethodName(methodName))
+    const auto& methodName = request["method"].get_ref<const std::string&>();
+    const auto method = _methods.find(methodName);
+    if (method == _methods.end())
     {
         if (isNotification)
             respond(json());
@@ -152,10 +218,11 @@ void RequestProcessor::_processCommand(const json& request,
         return;
     }
 
-    const auto params =
-        request.find("params") == request.end() ? "" : dump(request["params"]);
-
-    process(id, methodName, {params, clientID}, respond);
+    const auto params = request.find("params");
+    if (params == request.end())
+        method->second(id, {json(), clientID}, respond);
+    else
+        method->second(id, {*params, clientID}, respond);
 }
 }
 }
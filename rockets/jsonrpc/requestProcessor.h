@@ -20,12 +20,15 @@
 #ifndef ROCKETS_JSONRPC_REQUEST_PROCESSOR_H
 #define ROCKETS_JSONRPC_REQUEST_PROCESSOR_H
 
+#include <rockets/jsonrpc/jsonTypes.h>
 #include <rockets/jsonrpc/types.h>
 
-#include "../json.hpp"
+#include <unordered_map>
 
 namespace rockets
 {
+class WorkerPool;
+
 namespace jsonrpc
 {
 /**
@@ -48,41 +51,56 @@ public:
      * @param request Request object with message in JSON-RPC 2.0 format.
      * @param callback that return a json response string in JSON-RPC 2.0
      *        format upon request completion.
+     * @param encoding of the request message, used for the response too.
      */
-    void process(const Request& request, AsyncStringResponse callback);
+    void process(const Request& request, AsyncStringResponse callback,
+                 Encoding encoding = Encoding::json);
 
     /** Check if given method name is valid, throws otherwise. */
     virtual void verifyValidMethodName(const std::string& method) const;
 
+    /** Indent the JSON responses, they are compact by default. */
+    void setPrettyPrint(const bool pretty) { _prettyPrint = pretty; }
+
+    /**
+     * Set the executor for processing the entries of batch requests in
+     * parallel, nullptr to process them on the calling thread (default).
+     */
+    void setBatchExecutor(WorkerPool* executor) { _batchExecutor = executor; }
+
 protected:
     using json = rockets_nlohmann::json;
     using JsonResponseCallback = std::function<void(json)>;
 
-private:
     /**
      * Implements the processing of a valid JSON-RPC request. The minimum this
      * processing needs to do is to respond() the result of the request.
      *
      * @param requestID 'id' field of the JSON-RPC request
-     * @param method 'method' field of the JSON-RPC request
-     * @param request 'params' field of the JSON-RPC request and the client ID
+     * @param request 'params' field of the JSON-RPC request and the client ID,
+     *        only valid during the call
      * @param respond callback for responding JSON result of request processing
      */
-    virtual void process(const json& requestID, const std::string& method,
-                         const Request& request,
-                         JsonResponseCallback respond) = 0;
+    using Method = std::function<void(const json& requestID,
+                                      const JsonRequest& request,
+                                      JsonResponseCallback respond)>;
 
     /**
-     * @return true if the given method name is valid to continue calling
-     *         _process(), false otherwise
+     * Add a method to the dispatch table, replacing the one with the same name
+     * if any. The name is not verified.
      */
-    virtual bool isRegisteredMethodName(const std::string&) const = 0;
+    void addMethod(const std::string& name, Method method);
+
+private:
+    bool _prettyPrint = false;
+    WorkerPool* _batchExecutor = nullptr;
 
-    std::string _processBatchBlocking(const json& array, uintptr_t clientID);
+    // All the methods, whatever their type of callback, so that a request is
+    // dispatched with a single lookup.
+    std::unordered_map<std::string, Method> _methods;
 
-    json _processValidBatchBlocking(const json& array,
-                                    const uintptr_t clientID);
-    json _processCommandBlocking(const json& request, const uintptr_t clientID);
+    void _processBatch(json array, uintptr_t clientID,
+                       JsonResponseCallback respond);
     void _processCommand(const json& request, const uintptr_t clientID,
                          JsonResponseCallback respond);
 };
@@ -19,10 +19,8 @@
 
 #include "requester.h"
 
-#include "../json.hpp"
 #include "errorCodes.h"
-
-using namespace rockets_nlohmann;
+#include "utils.h"
 
 namespace rockets
 {
@@ -77,9 +75,9 @@ Response makeResponse(const json& object)
         return Response{
             Response::Error{error["message"].get<std::string>(),
                             error["code"].get<int>(),
-                            error.count("data") ? error["data"].dump(4) : ""}};
+                            error.count("data") ? error["data"].dump() : ""}};
     }
-    return Response{object["result"].dump(4)};
+    return Response{object["result"].dump()};
 }
 }
 
@@ -125,7 +123,7 @@ size_t Requester::request(const std::string& method, const std::string& params,
                 : makeRequest(method, _impl->lastId, json::parse(params));
 
         _impl->pendingRequests.emplace(_impl->lastId++, callback);
-        _send(requestJSON.dump(4));
+        _send(encode(requestJSON, _encoding, _prettyPrint));
     }
     catch (const json::parse_error&)
     {
@@ -134,9 +132,18 @@ size_t Requester::request(const std::string& method, const std::string& params,
     return _impl->lastId - 1;
 }
 
-bool Requester::processResponse(const std::string& json)
+bool Requester::processResponse(const std::string& message,
+                                const Encoding encoding)
 {
-    const auto response = json::parse(json, nullptr, false);
+    json response;
+    try
+    {
+        response = decode(message, encoding);
+    }
+    catch (const json::parse_error&)
+    {
+        return false;
+    }
     if (!isValidJsonRpcResponse(response))
         return false;
 
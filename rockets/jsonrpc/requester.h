@@ -137,11 +137,13 @@ protected:
     /**
      * Process a JSON-RPC response, calling the associated callback.
      *
-     * @param json response string in JSON-RPC 2.0 format.
-     * @return false if the string is not a valid JSON-RPC response or no
+     * @param message response in JSON-RPC 2.0 format.
+     * @param encoding of the message.
+     * @return false if the message is not a valid JSON-RPC response or no
      *         pending request matches the response id.
      */
-    bool processResponse(const std::string& json);
+    bool processResponse(const std::string& message,
+                         Encoding encoding = Encoding::json);
 
 private:
     static std::exception_ptr jsonConversionFailed();
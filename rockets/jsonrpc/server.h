@@ -21,7 +21,9 @@
 #define ROCKETS_JSONRPC_SERVER_H
 
 #include <rockets/jsonrpc/cancellableReceiver.h>
+#include <rockets/jsonrpc/helpers.h>
 #include <rockets/jsonrpc/notifier.h>
+#include <rockets/jsonrpc/publisher.h>
 #include <rockets/ws/types.h>
 
 namespace rockets
@@ -40,6 +42,18 @@ namespace jsonrpc
  * - void handleText(ws::MessageCallback callback);
  *   Used to register a callback for processing the requests and notifications
  *   coming from the client(s).
+ *
+ * - void sendText(std::string message, uintptr_t client);
+ *   Used for sending responses to a client.
+ *
+ * Exposing objects additionally requires:
+ *
+ * - std::set<uintptr_t> sendText(std::string message,
+ *                                std::set<uintptr_t> clients);
+ *   Used for sending the changes of an object to its subscribers, returning
+ *   the clients which are still connected.
+ *
+ * The bound methods must be thread-safe if setBatchThreadCount() is used.
  */
 template <typename CommunicatorT>
 class Server : public Notifier, public CancellableReceiver
@@ -57,6 +71,100 @@ public:
             });
     }
 
+    /**
+     * Indent the JSON messages for debugging.
+     *
+     * @param pretty true to indent, false for compact messages (default).
+     */
+    void setPrettyPrint(const bool pretty)
+    {
+        _prettyPrint = pretty;
+        CancellableReceiver::setPrettyPrint(pretty);
+    }
+
+    /**
+     * Accept requests in a binary encoding, in binary messages.
+     *
+     * The encoding is selected by each client with the websocket protocol it
+     * connects with: "<name>.msgpack" or "<name>.cbor", which the communicator
+     * must accept next to "<name>", e.g. rockets::Server{uri,
+     * "rockets,rockets.msgpack,rockets.cbor"}. Clients of other protocols use
+     * the default encoding, so clients of all encodings can be served at once.
+     *
+     * Requests in text messages are still accepted. The responses use the
+     * encoding of the request, notifications are always sent as text. This
+     * requires the communicator to also provide:
+     *
+     * - void handleBinary(ws::MessageCallbackAsync callback);
+     *   Used to register a callback for processing the binary requests.
+     *
+     * @param encoding of the binary requests of clients which did not select
+     *        one, Encoding::msgpack or Encoding::cbor.
+     */
+    void setBinaryEncoding(const Encoding encoding)
+    {
+        communicator.handleBinary(
+            [this, encoding](ws::Request request,
+                             ws::ResponseCallback callback) {
+                const auto requestEncoding =
+                    getBinaryEncoding(request.protocol, encoding);
+                process(std::move(request), callback, requestEncoding);
+            });
+    }
+
+    /**
+     * Expose an object to which clients can subscribe.
+     *
+     * The "<name>.subscribe" request returns the current state of the object,
+     * after which the client receives "<name>.patch" notifications with the
+     * JSON Patch (RFC 6902) of each change passed to publish(), until it sends
+     * "<name>.unsubscribe".
+     *
+     * The object must be serializable by a free function:
+     * std::string to_json(const Obj& object).
+     *
+     * @param name of the object.
+     * @param object to expose, must outlive the server.
+     * @throw std::invalid_argument if an object with the same name exists.
+     */
+    template <typename Obj>
+    void expose(const std::string& name, const Obj& object)
+    {
+        if (!publisher)
+        {
+            auto& server = communicator;
+            publisher.reset(new Publisher(
+                [&server](const std::string& message,
+                          const std::set<uintptr_t>& clients) {
+                    return server.sendText(message, clients);
+                }));
+        }
+        publisher->add(name, [&object] { return to_json(object); });
+
+        auto pub = publisher.get();
+        AsyncReceiver::bindAsyncJson(
+            name + ".subscribe",
+            [pub, name](const JsonRequest& request, AsyncJsonResponse respond) {
+                if (!pub->subscribe(name, request.clientID, respond))
+                    respond(Response::invalidParams().error);
+            });
+        bind(name + ".unsubscribe", [pub, name](const Request& request) {
+            pub->unsubscribe(name, request.clientID);
+            return Response{"\"OK\""};
+        });
+    }
+
+    /**
+     * Send the changes of an exposed object to its subscribers.
+     *
+     * @param name of the object.
+     * @return false if no object with this name was exposed.
+     */
+    bool publish(const std::string& name)
+    {
+        return publisher && publisher->publish(name);
+    }
+
 private:
     /** Notifier::_send */
     void _send(std::string json) final
@@ -65,6 +173,7 @@ private:
     }
 
     CommunicatorT& communicator;
+    std::unique_ptr<Publisher> publisher;
 };
 }
 }
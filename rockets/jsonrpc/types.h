@@ -32,7 +32,24 @@ namespace jsonrpc
 {
 using ws::Request;
 
+/**
+ * Encoding of the JSON-RPC messages.
+ *
+ * The binary encodings carry the same documents as JSON, in binary websocket
+ * frames. They are more compact and faster to parse, notably for messages
+ * with large numeric arrays.
+ */
+enum class Encoding
+{
+    json,    // text
+    msgpack, // MessagePack, binary
+    cbor     // Concise Binary Object Representation (RFC 7049), binary
+};
+
 class RequestProcessor;
+struct JsonCallback;            // defined in jsonTypes.h
+struct DelayedJsonCallback;     // defined in jsonTypes.h
+struct CancellableJsonCallback; // defined in jsonTypes.h
 
 /** @name Asynchronous response to a request. */
 //@{
@@ -20,9 +20,9 @@
 #ifndef ROCKETS_JSONRPC_UTILS_H
 #define ROCKETS_JSONRPC_UTILS_H
 
+#include <rockets/jsonrpc/jsonTypes.h>
 #include <rockets/jsonrpc/response.h>
-
-#include "../json.hpp"
+#include <rockets/jsonrpc/types.h>
 
 namespace rockets
 {
@@ -34,8 +34,6 @@ const std::string jsonResponseParseError =
 const Response::Error internalError{"Internal error",
                                     ErrorCode::internal_error};
 
-using json = rockets_nlohmann::json;
-
 inline json makeErrorResponse(const json& error, const json& id)
 {
     return json{{"jsonrpc", "2.0"}, {"error", error}, {"id", id}};
@@ -82,6 +80,62 @@ inline json makeResponse(const Response& rep, const json& id)
                          : makeResponse(rep.result, id);
 }
 
+inline json makeResponse(JsonResponse&& rep, const json& id)
+{
+    if (rep.isError())
+        return makeErrorResponse(rep.error, id);
+    return json{{"jsonrpc", "2.0"}, {"result", std::move(rep.result)},
+                {"id", id}};
+}
+
+/**
+ * Decode a message in the given encoding.
+ * @throw json::parse_error if the message is not valid.
+ */
+inline json decode(const std::string& message, const Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding::msgpack:
+        return json::from_msgpack(message);
+    case Encoding::cbor:
+        return json::from_cbor(message);
+    case Encoding::json:
+    default:
+        return json::parse(message);
+    }
+}
+
+/**
+ * @return the message encoding a JSON document in the given encoding,
+ *         indented if pretty and in Encoding::json, compact otherwise.
+ */
+inline std::string encode(const json& object, const Encoding encoding,
+                          const bool pretty = false)
+{
+    std::string message;
+    switch (encoding)
+    {
+    case Encoding::msgpack:
+        json::to_msgpack(object, message);
+        break;
+    case Encoding::cbor:
+        json::to_cbor(object, message);
+        break;
+    case Encoding::json:
+    default:
+        message = object.dump(pretty ? 4 : -1);
+    }
+    return message;
+}
+
+/** @return the request with its parameters in JSON format. */
+inline Request makeStringRequest(const JsonRequest& request)
+{
+    return {request.params.is_null() ? "" : request.params.dump(),
+            request.clientID};
+}
+
 inline bool begins_with(const std::string& string, const std::string& other)
 {
     return string.compare(0, other.length(), other) == 0;
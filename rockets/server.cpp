@@ -28,20 +28,61 @@
 #include "pollDescriptors.h"
 #include "serverContext.h"
 #include "serviceThreadPool.h"
+#include "taskQueue.h"
+#include "workerPool.h"
 #include "ws/channel.h"
 #include "ws/connection.h"
 #include "ws/messageHandler.h"
+#include "ws/topicTable.h"
 
 #include <libwebsockets.h>
 
+#include <atomic>
 #include <mutex>
 #include <set>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
 namespace
 {
 const std::string REQUEST_REGISTRY = "registry";
+const std::string DEFLATE_EXTENSION = "permessage-deflate";
+// above which responses are sent uncompressed
+const size_t COMPRESSION_QUEUE_SIZE = 1024;
+
+/**
+ * Connection state placed in the per-session memory that lws allocates (and
+ * zero-fills) for each connection, so that callbacks do not need a lookup.
+ */
+template <typename T>
+class Session
+{
+public:
+    static Session* from(void* user) { return static_cast<Session*>(user); }
+
+    template <typename... Args>
+    void open(Args&&... args)
+    {
+        new (&_storage) T(std::forward<Args>(args)...);
+        _open = true;
+    }
+
+    void close()
+    {
+        if (!_open)
+            return;
+        get().~T();
+        _open = false;
+    }
+
+    bool isOpen() const { return _open; }
+    T& get() { return *reinterpret_cast<T*>(&_storage); }
+
+private:
+    bool _open;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+};
 }
 
 namespace rockets
@@ -51,6 +92,40 @@ static int callback_http(lws* wsi, lws_callback_reasons reason, void* user,
 static int callback_websockets(lws* wsi, lws_callback_reasons reason,
                                void* user, void* in, const size_t len);
 
+/**
+ * Posts tasks to the service threads on behalf of the Responders, which the
+ * application may keep beyond the lifetime of the server.
+ */
+class ServiceTaskPoster
+{
+public:
+    using Post = std::function<void(int tsi, TaskQueue::Task task)>;
+
+    explicit ServiceTaskPoster(Post post)
+        : _post{std::move(post)}
+    {
+    }
+
+    /** Post a task, or discard it if closed (thread-safe). */
+    void post(const int tsi, TaskQueue::Task task)
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_post)
+            _post(tsi, std::move(task));
+    }
+
+    /** Discard the tasks posted from now on (thread-safe). */
+    void close()
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _post = nullptr;
+    }
+
+private:
+    std::mutex _mutex;
+    Post _post;
+};
+
 class Server::Impl
 {
 public:
@@ -59,12 +134,55 @@ public:
         : handler{registry}
         , wsHandler(wsConnections)
     {
-        context =
-            std::make_unique<ServerContext>(uri, name, threadCount,
-                                            callback_http, callback_websockets,
-                                            this, uvLoop);
+        context = std::make_unique<ServerContext>(
+            uri, name, threadCount, callback_http, sizeof(HttpSession),
+            callback_websockets, sizeof(WsSession), this, uvLoop);
         if (threadCount > 0)
             serviceThreadPool = std::make_unique<ServiceThreadPool>(*context);
+        context->setCancelCallback([this] { handleServiceRequests(); });
+        wsHandler.callbackWakeup = [this] { requestBroadcastAsync(); };
+        taskPoster = std::make_shared<ServiceTaskPoster>(
+            [this](const int tsi, TaskQueue::Task task) {
+                if (serviceThreadPool)
+                    serviceThreadPool->post(tsi, std::move(task));
+                else
+                {
+                    serviceTasks.push(std::move(task));
+                    context->cancelService();
+                }
+            });
+        handler.setPosterFactory([this] { return makeServiceThreadPoster(); });
+    }
+
+    ~Impl()
+    {
+        taskPoster->close();
+
+        // The service threads post to the handler executor, whose pending
+        // tasks can only be discarded once they are stopped.
+        serviceThreadPool.reset();
+        handler.setExecutor(nullptr);
+        handlerExecutor.reset();
+        handler.setCompressor(nullptr);
+    }
+
+    // @return a function posting tasks to the calling service thread
+    http::ResponderState::Post makeServiceThreadPoster()
+    {
+        const auto tsi = ServiceThreadPool::getCurrentThreadIndex();
+        return [ poster = taskPoster, tsi ](TaskQueue::Task task)
+        {
+            poster->post(tsi, std::move(task));
+        };
+    }
+
+    // Run the tasks posted to the calling service thread
+    void runServiceThreadTasks()
+    {
+        if (serviceThreadPool)
+            serviceThreadPool->runTasks();
+        else
+            serviceTasks.run();
     }
 
     void requestBroadcast()
@@ -75,45 +193,129 @@ public:
             context->requestBroadcast();
     }
 
-    void openWsConnection(lws* wsi)
+    // Thread-safe variant of requestBroadcast(), for messages that are queued
+    // outside of the process() calls when not using service threads.
+    void requestBroadcastAsync()
+    {
+        if (serviceThreadPool)
+            serviceThreadPool->requestBroadcast();
+        else
+        {
+            broadcastRequested = true;
+            context->cancelService();
+        }
+    }
+
+    void handleBroadcastRequest()
+    {
+        if (broadcastRequested.exchange(false))
+            context->requestBroadcast();
+    }
+
+    // Handle what other threads requested through cancelService(), from the
+    // service loop which may be a libuv loop not driven by process()
+    void handleServiceRequests()
+    {
+        handleBroadcastRequest();
+        runServiceThreadTasks();
+    }
+
+    using HttpSession = Session<http::Connection>;
+    using WsSession = Session<ws::ConnectionPtr>;
+
+    bool acceptsExtension(const char* name) const
+    {
+        return wsCompressionEnabled && name && name == DEFLATE_EXTENSION;
+    }
+
+    void openWsConnection(lws* wsi, WsSession& session)
     {
-        std::lock_guard<std::mutex> lock{wsConnectionsMutex};
-        auto connection = std::make_shared<ws::Connection>(
-            std::make_unique<ws::Channel>(wsi));
-        wsConnections.emplace(wsi, connection);
+        auto channel = std::make_unique<ws::Channel>(wsi);
+        if (wsCompressionEnabled)
+            channel->setCompression(wsCompression, true);
+        auto connection =
+            std::make_shared<ws::Connection>(std::move(channel), wsQueueOptions,
+                                             makeOverflowCallback());
+        session.open(connection);
+        wsConnections.add(wsi, connection);
         wsHandler.handleOpenConnection(connection);
     }
 
-    void closeWsConnection(lws* wsi)
+    // @return a function closing the overflowed connections of the calling
+    // service thread, as their socket may never become writable again
+    ws::Connection::OverflowCallback makeOverflowCallback()
     {
-        std::lock_guard<std::mutex> lock{wsConnectionsMutex};
-        wsHandler.handleCloseConnection(wsConnections.at(wsi));
-        wsConnections.erase(wsi);
+        return [ this, post = makeServiceThreadPoster() ](const uintptr_t id)
+        {
+            post([this, id] {
+                if (auto connection = wsConnections.findClient(id))
+                    connection->closeOverflowed();
+            });
+        };
     }
 
-    void handleReceive(lws* wsi, const char* data, const size_t len)
+    void closeWsConnection(lws* wsi, WsSession& session)
     {
-        std::lock_guard<std::mutex> lock{wsConnectionsMutex};
-        wsHandler.handleMessage(wsConnections.at(wsi), data, len);
+        if (auto connection = wsConnections.remove(wsi))
+        {
+            wsTopics.removeClient(connection->getClientID());
+            wsHandler.handleCloseConnection(connection);
+        }
+        session.close();
     }
 
-    void handleWrite(lws* wsi)
+    void publish(const std::string& topic, const ws::BufferPtr& buffer,
+                 const ws::Format format, const bool conflate)
     {
-        std::lock_guard<std::mutex> lock{wsConnectionsMutex};
-        wsConnections.at(wsi)->writeMessages();
+        const auto subscribers = wsTopics.getSubscribers(topic);
+        if (!subscribers)
+            return;
+
+        for (const auto& subscriber : *subscribers)
+        {
+            auto& connection = subscriber.second;
+            if (conflate)
+                connection->conflate(buffer, format, topic);
+            else
+                connection->enqueue(buffer, format);
+        }
+        requestBroadcast();
+    }
+
+    int handleReceive(WsSession& session, const char* data, const size_t len)
+    {
+        if (session.isOpen() &&
+            !wsHandler.handleMessage(session.get(), data, len))
+        {
+            return -1; // close the connection
+        }
+        return 0;
+    }
+
+    int handleWrite(WsSession& session)
+    {
+        if (session.isOpen() && !session.get()->writeMessages())
+            return -1; // close the connection
+        return 0;
     }
 
     http::Registry registry;
     http::ConnectionHandler handler;
-    std::map<lws*, http::Connection> connections;
+    std::unique_ptr<WorkerPool> handlerExecutor;
 
-    std::mutex wsConnectionsMutex;
-    ws::Connections wsConnections;
+    ws::ConnectionTable wsConnections;
+    ws::TopicTable wsTopics;
     ws::MessageHandler wsHandler;
+    ws::QueueOptions wsQueueOptions;
+    bool wsCompressionEnabled = false;
+    ws::CompressionOptions wsCompression;
 
     PollDescriptors pollDescriptors;
+    std::atomic_bool broadcastRequested{false};
+    TaskQueue serviceTasks;
     std::unique_ptr<ServerContext> context;
     std::unique_ptr<ServiceThreadPool> serviceThreadPool;
+    std::shared_ptr<ServiceTaskPoster> taskPoster;
 };
 
 Server::Server(const std::string& uri, const std::string& name,
@@ -160,8 +362,45 @@ void Server::setHttpFilter(const http::Filter* filter)
     _impl->handler.setFilter(filter);
 }
 
+void Server::setHandlerThreadCount(const unsigned int threadCount,
+                                   const size_t maxQueueSize)
+{
+    _impl->handler.setExecutor(nullptr);
+    _impl->handlerExecutor.reset();
+    if (threadCount == 0)
+        return;
+
+    _impl->handlerExecutor =
+        std::make_unique<WorkerPool>(threadCount, maxQueueSize);
+    _impl->handler.setExecutor(_impl->handlerExecutor.get());
+}
+
+unsigned int Server::getHandlerThreadCount() const
+{
+    const auto& executor = _impl->handlerExecutor;
+    return executor ? executor->getSize() : 0;
+}
+
+bool Server::setCompression(const http::CompressionOptions& options)
+{
+    _impl->handler.setCompressor(nullptr);
+    if (!http::Compressor::isSupported())
+        return false;
+
+    if (options.level <= 0)
+        return true;
+
+    std::shared_ptr<WorkerPool> executor;
+    if (options.threadCount > 0)
+        executor = std::make_shared<WorkerPool>(options.threadCount,
+                                                COMPRESSION_QUEUE_SIZE);
+    _impl->handler.setCompressor(std::make_shared<http::Compressor>(options),
+                                 std::move(executor));
+    return true;
+}
+
 bool Server::handle(const http::Method action, const std::string& endpoint,
-                    http::RESTFunc func)
+                    http::ReplyFunc func)
 {
     if (endpoint == REQUEST_REGISTRY)
         throw std::invalid_argument("'registry' is a reserved endpoint");
@@ -169,6 +408,38 @@ bool Server::handle(const http::Method action, const std::string& endpoint,
     return _impl->registry.add(action, endpoint, func);
 }
 
+bool Server::handle(const http::Method action, const std::string& endpoint,
+                    http::ReplyFunc func, const http::BodyOptions& options)
+{
+    if (endpoint == REQUEST_REGISTRY)
+        throw std::invalid_argument("'registry' is a reserved endpoint");
+
+    return _impl->registry.add(action, endpoint, {func, {}, {}, options});
+}
+
+bool Server::handleAsync(const http::Method action,
+                         const std::string& endpoint,
+                         http::AsyncRESTFunc func)
+{
+    if (endpoint == REQUEST_REGISTRY)
+        throw std::invalid_argument("'registry' is a reserved endpoint");
+
+    return _impl->registry.add(action, endpoint, {{}, func, {}, {}});
+}
+
+bool Server::handleStream(const http::Method action,
+                          const std::string& endpoint,
+                          http::BodySinkFactory factory,
+                          const size_t maxBodySize)
+{
+    if (endpoint == REQUEST_REGISTRY)
+        throw std::invalid_argument("'registry' is a reserved endpoint");
+
+    http::BodyOptions options;
+    options.maxSize = maxBodySize;
+    return _impl->registry.add(action, endpoint, {{}, {}, factory, options});
+}
+
 bool Server::remove(const std::string& endpoint)
 {
     return _impl->registry.remove(endpoint);
@@ -199,53 +470,163 @@ void Server::handleBinary(ws::MessageCallback callback)
     _impl->wsHandler.callbackBinary = callback;
 }
 
+void Server::handleBinary(ws::MessageCallbackAsync callback)
+{
+    _impl->wsHandler.callbackBinaryAsync = callback;
+}
+
 void Server::broadcastText(const std::string& message)
 {
-    std::lock_guard<std::mutex> lock{_impl->wsConnectionsMutex};
-    for (auto& connection : _impl->wsConnections)
-        connection.second->enqueueText(message);
+    const auto buffer = std::make_shared<ws::Buffer>(message);
+    for (auto& connection : _impl->wsConnections.getSnapshot()->connections)
+        connection.second->enqueue(buffer, ws::Format::text);
     _impl->requestBroadcast();
 }
 
 void Server::broadcastText(const std::string& message,
                            const std::set<uintptr_t>& filter)
 {
-    std::lock_guard<std::mutex> lock{_impl->wsConnectionsMutex};
-    for (auto& connection : _impl->wsConnections)
+    const auto buffer = std::make_shared<ws::Buffer>(message);
+    const auto connections = _impl->wsConnections.getSnapshot();
+    const auto excluded = connections->getSlotMask(filter);
+    for (size_t slot = 0; slot < connections->slots.size(); ++slot)
     {
-        auto i =
-            filter.find(reinterpret_cast<uintptr_t>(connection.second.get()));
-        if (i == filter.end())
-            connection.second->enqueueText(message);
+        const auto& connection = connections->slots[slot];
+        if (connection && !excluded[slot])
+            connection->enqueue(buffer, ws::Format::text);
     }
     _impl->requestBroadcast();
 }
 
+void Server::broadcastConflatedText(const std::string& key,
+                                    const std::string& message)
+{
+    const auto buffer = std::make_shared<ws::Buffer>(message);
+    for (auto& connection : _impl->wsConnections.getSnapshot()->connections)
+        connection.second->conflate(buffer, ws::Format::text, key);
+    _impl->requestBroadcast();
+}
+
+bool Server::subscribe(const uintptr_t client, const std::string& topic)
+{
+    auto connection = _impl->wsConnections.findClient(client);
+    if (!connection)
+        return false;
+    if (!_impl->wsTopics.subscribe(topic, client, std::move(connection)))
+        return false;
+
+    // undo if the client was removed from the topics while subscribing,
+    // otherwise its connection would be kept forever
+    if (!_impl->wsConnections.findClient(client))
+    {
+        _impl->wsTopics.unsubscribe(topic, client);
+        return false;
+    }
+    return true;
+}
+
+bool Server::unsubscribe(const uintptr_t client, const std::string& topic)
+{
+    return _impl->wsTopics.unsubscribe(topic, client);
+}
+
+size_t Server::getSubscriberCount(const std::string& topic) const
+{
+    const auto subscribers = _impl->wsTopics.getSubscribers(topic);
+    return subscribers ? subscribers->size() : 0;
+}
+
+void Server::publishText(const std::string& topic, const std::string& message)
+{
+    _impl->publish(topic, std::make_shared<ws::Buffer>(message),
+                   ws::Format::text, false);
+}
+
+void Server::publishConflatedText(const std::string& topic,
+                                  const std::string& message)
+{
+    _impl->publish(topic, std::make_shared<ws::Buffer>(message),
+                   ws::Format::text, true);
+}
+
+void Server::publishBinary(const std::string& topic, const char* data,
+                           const size_t size)
+{
+    _impl->publish(topic, std::make_shared<ws::Buffer>(data, size),
+                   ws::Format::binary, false);
+}
+
 void Server::sendText(const std::string& message, uintptr_t client)
 {
-    std::lock_guard<std::mutex> lock{_impl->wsConnectionsMutex};
-    for (auto& connection : _impl->wsConnections)
+    if (auto connection = _impl->wsConnections.findClient(client))
+        connection->enqueueText(message);
+    _impl->requestBroadcast();
+}
+
+std::set<uintptr_t> Server::sendText(const std::string& message,
+                                     const std::set<uintptr_t>& clients)
+{
+    const auto buffer = std::make_shared<ws::Buffer>(message);
+    std::set<uintptr_t> connected;
+    for (const auto client : clients)
     {
-        if (client == reinterpret_cast<uintptr_t>(connection.second.get()))
-            connection.second->enqueueText(message);
+        if (auto connection = _impl->wsConnections.findClient(client))
+        {
+            connection->enqueue(buffer, ws::Format::text);
+            connected.insert(client);
+        }
     }
     _impl->requestBroadcast();
+    return connected;
 }
 
 void Server::broadcastBinary(const char* data, const size_t size)
 {
-    std::lock_guard<std::mutex> lock{_impl->wsConnectionsMutex};
-    for (auto& connection : _impl->wsConnections)
-        connection.second->enqueueBinary({data, size});
+    const auto buffer = std::make_shared<ws::Buffer>(data, size);
+    for (auto& connection : _impl->wsConnections.getSnapshot()->connections)
+        connection.second->enqueue(buffer, ws::Format::binary);
     _impl->requestBroadcast();
 }
 
 size_t Server::getConnectionCount() const
 {
-    std::lock_guard<std::mutex> lock{_impl->wsConnectionsMutex};
     return _impl->wsConnections.size();
 }
 
+void Server::setWebsocketQueueLimits(const ws::QueueOptions& options)
+{
+    _impl->wsQueueOptions = options;
+}
+
+void Server::setWebsocketMaxMessageSize(const size_t size)
+{
+    _impl->wsHandler.maxMessageSize = size;
+}
+
+ws::QueueStats Server::getQueueStats(const uintptr_t client) const
+{
+    if (auto connection = _impl->wsConnections.findClient(client))
+        return connection->getQueueStats();
+    return ws::QueueStats();
+}
+
+bool Server::isCompressed(const uintptr_t client) const
+{
+    auto connection = _impl->wsConnections.findClient(client);
+    return connection && connection->getChannel().isCompressed();
+}
+
+bool Server::setWebsocketCompression(const ws::CompressionOptions& options)
+{
+    _impl->wsCompressionEnabled = false;
+    if (!websocket_extensions())
+        return false;
+
+    _impl->wsCompression = options;
+    _impl->wsCompressionEnabled = options.level > 0;
+    return true;
+}
+
 void Server::_setSocketListener(SocketListener* listener)
 {
     _impl->pollDescriptors.setListener(listener);
@@ -253,6 +634,7 @@ void Server::_setSocketListener(SocketListener* listener)
 
 void Server::_processSocket(const SocketDescriptor fd, const int events)
 {
+    _impl->handleServiceRequests();
     _impl->context->service(_impl->pollDescriptors, fd, events);
 }
 
@@ -260,51 +642,60 @@ void Server::_process(const int timeout_ms)
 {
     if (_impl->serviceThreadPool)
         throw std::logic_error("No process() when using service threads");
+    _impl->handleServiceRequests();
     _impl->context->service(timeout_ms);
 }
 
 static int callback_http(lws* wsi, const lws_callback_reasons reason,
-                         void* /*user*/, void* in, const size_t len)
+                         void* user, void* in, const size_t len)
 {
     // Protocol may be null during the initial callbacks
     if (auto protocol = lws_get_protocol(wsi))
     {
         auto impl = static_cast<Server::Impl*>(protocol->user);
         const auto& handler = impl->handler;
-        auto& connections = impl->connections;
+        auto session = Server::Impl::HttpSession::from(user);
 
         switch (reason)
         {
         case LWS_CALLBACK_HTTP:
             // connection "open" may occur multiple times (lws v2.0-stable)
-            if (!connections
-                     .emplace(wsi, http::Connection{wsi, (const char*)in})
-                     .second)
-            {
+            if (!session || session->isOpen())
                 return -1;
-            }
-            handler.handleNewRequest(connections.at(wsi));
+            session->open(wsi, (const char*)in);
+            handler.handleNewRequest(session->get());
             break;
         case LWS_CALLBACK_HTTP_BODY:
-            handler.handleData(connections.at(wsi), (const char*)in, len);
+            if (session && session->isOpen())
+                handler.handleData(session->get(), (const char*)in, len);
             break;
         case LWS_CALLBACK_HTTP_BODY_COMPLETION:
-            handler.prepareResponse(connections.at(wsi));
+            if (session && session->isOpen())
+                handler.prepareResponse(session->get());
             break;
 
         case LWS_CALLBACK_HTTP_WRITEABLE:
             // A writable callback may exceptionally occcur without a connection
-            if (connections.count(wsi))
-                return handler.writeResponse(connections.at(wsi));
+            if (session && session->isOpen())
+                return handler.writeResponse(session->get());
             break;
 
 #if LWS_LIBRARY_VERSION_NUMBER >= 2001000
         case LWS_CALLBACK_HTTP_DROP_PROTOCOL: // fall-through
 #endif
         case LWS_CALLBACK_CLOSED_HTTP:
-            connections.erase(wsi);
+            if (session)
+                session->close();
             break;
 
+#if LWS_LIBRARY_VERSION_NUMBER >= 3000000
+        case LWS_CALLBACK_EVENT_WAIT_CANCELLED:
+            // lws_cancel_service() from another thread, also with libuv
+            impl->handleServiceRequests();
+            break;
+#endif
+        case LWS_CALLBACK_CONFIRM_EXTENSION_OKAY:
+            return impl->acceptsExtension((const char*)in) ? 0 : 1;
         case LWS_CALLBACK_ADD_POLL_FD:
             impl->pollDescriptors.add(static_cast<lws_pollargs*>(in));
             break;
@@ -322,27 +713,30 @@ static int callback_http(lws* wsi, const lws_callback_reasons reason,
 }
 
 static int callback_websockets(lws* wsi, const lws_callback_reasons reason,
-                               void* /*user*/, void* in, const size_t len)
+                               void* user, void* in, const size_t len)
 {
-    // Protocol may be null during the initial callbacks
+    // Protocol and session may be null during the initial callbacks
+    auto session = Server::Impl::WsSession::from(user);
     if (auto protocol = lws_get_protocol(wsi))
     {
         auto impl = static_cast<Server::Impl*>(protocol->user);
+        if (reason == LWS_CALLBACK_CONFIRM_EXTENSION_OKAY)
+            return impl->acceptsExtension((const char*)in) ? 0 : 1;
+        if (!session)
+            return 0;
 
         switch (reason)
         {
         case LWS_CALLBACK_ESTABLISHED:
-            impl->openWsConnection(wsi);
+            impl->openWsConnection(wsi, *session);
             break;
         case LWS_CALLBACK_CLOSED:
-            impl->closeWsConnection(wsi);
+            impl->closeWsConnection(wsi, *session);
             break;
         case LWS_CALLBACK_RECEIVE:
-            impl->handleReceive(wsi, (const char*)in, len);
-            break;
+            return impl->handleReceive(*session, (const char*)in, len);
         case LWS_CALLBACK_SERVER_WRITEABLE:
-            impl->handleWrite(wsi);
-            break;
+            return impl->handleWrite(*session);
         default:
             break;
         }
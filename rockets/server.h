@@ -22,9 +22,13 @@
 #ifndef ROCKETS_SERVER_H
 #define ROCKETS_SERVER_H
 
+#include <rockets/http/bodySink.h>
 #include <rockets/http/filter.h>
 #include <rockets/http/helpers.h>
+#include <rockets/http/reply.h>
 #include <rockets/http/request.h>
+#include <rockets/http/responder.h>
+#include <rockets/http/versionedContent.h>
 #include <rockets/socketBasedInterface.h>
 #include <rockets/ws/types.h>
 
@@ -61,6 +65,8 @@ public:
      *
      * @param uri The server address in the form "[hostname|IP|iface][:port]".
      * @param name The name of the websockets protocol, disabled if empty.
+     *        A comma-separated list of names accepts clients connecting with
+     *        any of them, see ws::Request::protocol.
      * @param threadCount The number of internal service threads to use.
      * @throw std::runtime_error on malformed URI or connection issues.
      */
@@ -81,6 +87,8 @@ public:
      * @param uvLoop The libuv loop to run the send & receive operations on.
      * @param uri The server address in the form "[hostname|IP|iface][:port]".
      * @param name The name of the websockets protocol, disabled if empty.
+     *        A comma-separated list of names accepts clients connecting with
+     *        any of them, see ws::Request::protocol.
      * @throw std::runtime_error on malformed URI, connection issues or no libuv
      * suppport.
      */
@@ -105,6 +113,46 @@ public:
      * @param filter to set, nullptr to remove.
      */
     ROCKETS_API void setHttpFilter(const http::Filter* filter);
+
+    /**
+     * Execute the HTTP handlers on a dedicated pool of worker threads.
+     *
+     * By default, the handlers are called from the thread serving the
+     * connection (an internal service thread or the one calling process()),
+     * which delays all other connections served by the same thread until they
+     * return. With an executor, they run on the worker threads instead and
+     * their responses are written by the service thread once ready.
+     *
+     * Must be called before processing any request.
+     *
+     * @param threadCount the number of worker threads, 0 to disable.
+     * @param maxQueueSize the maximum number of requests waiting for a worker,
+     *        above which new requests are answered with 503 Service
+     *        Unavailable.
+     */
+    ROCKETS_API void setHandlerThreadCount(unsigned int threadCount,
+                                           size_t maxQueueSize = 1024);
+
+    /** @return the number of worker threads executing the HTTP handlers. */
+    ROCKETS_API unsigned int getHandlerThreadCount() const;
+
+    /**
+     * Compress the HTTP responses for the clients which accept it.
+     *
+     * The payload is compressed with gzip or deflate, as negotiated with the
+     * Accept-Encoding header of each request. Compression runs on
+     * options.threadCount worker threads, off the service threads; responses
+     * are sent uncompressed while too many of them are waiting for it. With
+     * no threads, it happens where the response is produced. The compressed
+     * payload of responses with an ETag, such as the ones of handleGET() with
+     * a version, is cached.
+     *
+     * Must be called before processing any request.
+     *
+     * @param options for compressing the responses, level 0 to disable.
+     * @return false if Rockets was built without compression support.
+     */
+    ROCKETS_API bool setCompression(const http::CompressionOptions& options);
     //@}
 
     /** @name HTTP functionality */
@@ -112,15 +160,77 @@ public:
     /**
      * Handle a single method on a given endpoint.
      *
+     * The handler may return a Response directly, or a std::future<Response>
+     * if it is not ready yet (see RESTFunc).
+     *
+     * The endpoint may contain path parameters such as "volumes/{id}", see
+     * http::Request.
+     *
+     * @param method to handle
+     * @param endpoint the endpoint to receive requests for during receive().
+     * @param func the callback function for serving the request.
+     * @return true if subscription was successful.
+     * @throw std::invalid_argument if attempting to register "registry"
+     *        endpoint or an endpoint with invalid path parameters.
+     */
+    ROCKETS_API bool handle(http::Method method, const std::string& endpoint,
+                            http::ReplyFunc func);
+
+    /**
+     * Handle a single method on a given endpoint, with options for receiving
+     * the payload of the requests.
+     *
+     * Requests with a payload larger than options.maxSize are rejected with
+     * PAYLOAD_TOO_LARGE (413) before it is received, if possible.
+     *
      * @param method to handle
      * @param endpoint the endpoint to receive requests for during receive().
      * @param func the callback function for serving the request.
+     * @param options for receiving the payload.
      * @return true if subscription was successful.
      * @throw std::invalid_argument if attempting to register "registry"
-     *        endpoint.
+     *        endpoint or an endpoint with invalid path parameters.
      */
     ROCKETS_API bool handle(http::Method method, const std::string& endpoint,
-                            http::RESTFunc func);
+                            http::ReplyFunc func,
+                            const http::BodyOptions& options);
+
+    /**
+     * Handle a single method on a given endpoint, with an asynchronous
+     * response.
+     *
+     * The handler completes the request through the given Responder, from any
+     * thread. The connection is not polled in the meantime: its service thread
+     * is woken up once the response is given.
+     *
+     * @param method to handle
+     * @param endpoint the endpoint to receive requests for during receive().
+     * @param func the callback function for serving the request.
+     * @return true if subscription was successful.
+     * @throw std::invalid_argument if attempting to register "registry"
+     *        endpoint or an endpoint with invalid path parameters.
+     */
+    ROCKETS_API bool handleAsync(http::Method method,
+                                 const std::string& endpoint,
+                                 http::AsyncRESTFunc func);
+
+    /**
+     * Handle a single method on a given endpoint, streaming the payload of
+     * each request to a BodySink instead of accumulating it in memory.
+     *
+     * @param method to handle
+     * @param endpoint the endpoint to receive requests for during receive().
+     * @param factory creating the sink for each new request.
+     * @param maxBodySize requests with a larger payload are rejected with
+     *        PAYLOAD_TOO_LARGE (413), 0 for unlimited.
+     * @return true if subscription was successful.
+     * @throw std::invalid_argument if attempting to register "registry"
+     *        endpoint or an endpoint with invalid path parameters.
+     */
+    ROCKETS_API bool handleStream(http::Method method,
+                                  const std::string& endpoint,
+                                  http::BodySinkFactory factory,
+                                  size_t maxBodySize = 0);
 
     /**
      * Handle a JSON-serializable object.
@@ -147,8 +257,32 @@ public:
     {
         using namespace rockets::http;
         return handle(Method::GET, endpoint, [&object](const Request&) {
-            return make_ready_response(http::Code::OK, to_json(object),
-                                       "application/json");
+            return Response{Code::OK, to_json(object), "application/json"};
+        });
+    }
+
+    /**
+     * Expose a JSON-serializable object, serialized only once per version.
+     *
+     * The serialized object is cached and returned with an ETag, requests
+     * for an unchanged version get NOT_MODIFIED, see http::VersionedContent.
+     *
+     * @param endpoint for accessing the object.
+     * @param object to expose.
+     * @param getVersion returns the version of the object, which must be
+     *        incremented each time the object changes.
+     * @return true if subscription was successful.
+     */
+    template <typename Obj>
+    bool handleGET(const std::string& endpoint, Obj& object,
+                   http::VersionedContent::VersionFunc getVersion)
+    {
+        using namespace rockets::http;
+        const auto content = std::make_shared<VersionedContent>(
+            [&object] { return to_json(object); }, std::move(getVersion),
+            "application/json");
+        return handle(Method::GET, endpoint, [content](const Request& req) {
+            return content->respond(req);
         });
     }
 
@@ -165,7 +299,7 @@ public:
         using namespace rockets::http;
         return handle(Method::PUT, endpoint, [&object](const Request& req) {
             const auto success = from_json(object, req.body);
-            return make_ready_response(success ? Code::OK : Code::BAD_REQUEST);
+            return Response{success ? Code::OK : Code::BAD_REQUEST};
         });
     }
 
@@ -177,7 +311,12 @@ public:
     ROCKETS_API bool remove(const std::string& endpoint);
     //@}
 
-    /** @name Websockets functionality */
+    /**
+     * @name Websockets functionality
+     *
+     * The open, close and message callbacks are called from the service
+     * threads, but never concurrently.
+     */
     //@{
     /** Set a callback for handling incoming connections. */
     ROCKETS_API void handleOpen(ws::ConnectionCallback callback);
@@ -194,6 +333,9 @@ public:
     /** Set a callback for handling binray messages from websocket clients. */
     ROCKETS_API void handleBinary(ws::MessageCallback callback);
 
+    /** Set a callback for handling binary messages from websocket clients. */
+    ROCKETS_API void handleBinary(ws::MessageCallbackAsync callback);
+
     /** Broadcast a text message to all websocket clients. */
     ROCKETS_API void broadcastText(const std::string& message);
 
@@ -204,14 +346,126 @@ public:
     ROCKETS_API void broadcastText(const std::string& message,
                                    const std::set<uintptr_t>& filter);
 
-    /** Send a text message to the given client. */
+    /**
+     * Broadcast the latest value of a stream to all websocket clients.
+     *
+     * The message replaces the one with the same key which is still queued
+     * for a client, if any, instead of being appended to its queue. Slow
+     * clients thus skip the intermediate values and always receive the most
+     * recent one, which bounds the memory used for them.
+     *
+     * @param key identifying the stream, e.g. "camera".
+     * @param message to send.
+     */
+    ROCKETS_API void broadcastConflatedText(const std::string& key,
+                                            const std::string& message);
+
+    /**
+     * Send a text message to the given client.
+     *
+     * The lookup of the client is O(1). Client IDs are never reused for a
+     * different connection, a message for a disconnected client is dropped.
+     */
     ROCKETS_API void sendText(const std::string& message, uintptr_t client);
 
+    /**
+     * Send a text message to several clients.
+     *
+     * @param message to send.
+     * @param clients to send the message to.
+     * @return the clients which are still connected.
+     */
+    ROCKETS_API std::set<uintptr_t> sendText(
+        const std::string& message, const std::set<uintptr_t>& clients);
+
+    /**
+     * Subscribe a websocket client to a topic.
+     *
+     * Clients are unsubscribed from all topics when they disconnect.
+     *
+     * @return false if the client is not connected or already subscribed.
+     */
+    ROCKETS_API bool subscribe(uintptr_t client, const std::string& topic);
+
+    /** @return false if the client was not subscribed to the topic. */
+    ROCKETS_API bool unsubscribe(uintptr_t client, const std::string& topic);
+
+    /** @return the number of clients subscribed to a topic. */
+    ROCKETS_API size_t getSubscriberCount(const std::string& topic) const;
+
+    /**
+     * Send a text message to the clients subscribed to a topic.
+     *
+     * The cost is proportional to the number of subscribers of the topic, and
+     * the message is shared by all of them without being copied.
+     */
+    ROCKETS_API void publishText(const std::string& topic,
+                                 const std::string& message);
+
+    /**
+     * Send the latest value of a topic to its subscribers, replacing the
+     * previous value if it is still queued for a subscriber.
+     *
+     * @sa broadcastConflatedText()
+     */
+    ROCKETS_API void publishConflatedText(const std::string& topic,
+                                          const std::string& message);
+
+    /** Send a binary message to the clients subscribed to a topic. */
+    ROCKETS_API void publishBinary(const std::string& topic, const char* data,
+                                   size_t size);
+
     /** Broadcast a binary message to all websocket clients. */
     ROCKETS_API void broadcastBinary(const char* data, size_t size);
 
     /** @return the number of connected websockets clients. */
     ROCKETS_API size_t getConnectionCount() const;
+
+    /**
+     * Bound the queue of outgoing messages of each websocket connection.
+     *
+     * Without limits, the messages sent to a client which does not read them
+     * fast enough accumulate without bounds. Unlimited by default.
+     *
+     * Applies to the connections opened afterwards.
+     *
+     * @param options the limits and the policy applied when they are reached.
+     */
+    ROCKETS_API void setWebsocketQueueLimits(const ws::QueueOptions& options);
+
+    /**
+     * Limit the size of incoming websocket messages. Unlimited by default.
+     *
+     * Clients sending a bigger message are disconnected with status 1009
+     * (message too big), before the message is buffered.
+     *
+     * @param size the maximum size of a message in bytes, 0 for unlimited.
+     */
+    ROCKETS_API void setWebsocketMaxMessageSize(size_t size);
+
+    /**
+     * @return the counters of the queue of outgoing messages of a client, all
+     *         zero if it is not connected.
+     */
+    ROCKETS_API ws::QueueStats getQueueStats(uintptr_t client) const;
+
+    /**
+     * Compress the websocket messages with permessage-deflate, for the clients
+     * which offer it. Disabled by default.
+     *
+     * Must be called before accepting any websocket connection.
+     *
+     * @param options for compressing the messages, level 0 to disable.
+     * @return false if libwebsockets was built without extension support.
+     */
+    ROCKETS_API bool setWebsocketCompression(
+        const ws::CompressionOptions& options);
+
+    /**
+     * @return true if the messages of a client are compressed with
+     *         permessage-deflate, false if it is not connected.
+     */
+    ROCKETS_API bool isCompressed(uintptr_t client) const;
     //@}
 
     class Impl; // must be public for static_cast from C callback
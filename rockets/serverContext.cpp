@@ -24,6 +24,7 @@
 #include "unavailablePortError.h"
 #include "ws/connection.h"
 
+#include <sstream>
 #include <string.h> // memset
 
 #if LWS_LIBRARY_VERSION_NUMBER >= 3000000
@@ -44,17 +45,27 @@ void signal_cb(uv_signal_t*, int)
 {
 }
 #endif
+#if LWS_LIBRARY_VERSION_NUMBER < 3000000
+void cancel_cb(uv_async_t* handle)
+{
+    const auto& callback = *static_cast<std::function<void()>*>(handle->data);
+    if (callback)
+        callback();
+}
+#endif
 #endif
 ServerContext::ServerContext(const std::string& uri, const std::string& name,
                              const unsigned int threadCount,
                              lws_callback_function* callback,
-                             lws_callback_function* wsCallback, void* user,
+                             const size_t sessionDataSize,
+                             lws_callback_function* wsCallback,
+                             const size_t wsSessionDataSize, void* user,
                              void* uvLoop)
-    : protocols{make_protocol("http", callback, user), null_protocol()}
-    , wsProtocolName{name}
+    : protocols{make_protocol("http", callback, user, sessionDataSize),
+                null_protocol()}
 {
-    if (!wsProtocolName.empty() && wsCallback)
-        createWebsocketsProtocol(wsCallback, user);
+    if (!name.empty() && wsCallback)
+        createWebsocketsProtocols(name, wsCallback, wsSessionDataSize, user);
 
     fillContextInfo(uri, threadCount);
 
@@ -104,11 +115,35 @@ ServerContext::ServerContext(const std::string& uri, const std::string& name,
 #else
         lws_uv_initloop(context.get(), uvLoop_, 0);
 #endif
+        // lws_cancel_service() does not wake up the libuv loop
+        cancelAsync = new uv_async_t;
+        if (uv_async_init(uvLoop_, cancelAsync, cancel_cb) != 0)
+        {
+            delete cancelAsync;
+            cancelAsync = nullptr;
+            throw std::runtime_error("libuv async handle init failed");
+        }
+        cancelAsync->data = &cancelCallback;
+        uv_unref(reinterpret_cast<uv_handle_t*>(cancelAsync));
     }
 #endif
 #endif
 }
 
+ServerContext::~ServerContext()
+{
+#ifdef LWS_WITH_LIBUV
+#if LWS_LIBRARY_VERSION_NUMBER < 3000000
+    // the loop frees the handle once closed, it may outlive the context
+    if (cancelAsync)
+        uv_close(reinterpret_cast<uv_handle_t*>(cancelAsync),
+                 [](uv_handle_t* handle) {
+                     delete reinterpret_cast<uv_async_t*>(handle);
+                 });
+#endif
+#endif
+}
+
 std::string ServerContext::getHostname() const
 {
     return interface.empty() ? rockets::getHostname() : getIP(interface);
@@ -126,7 +161,8 @@ int ServerContext::getThreadCount() const
 
 void ServerContext::requestBroadcast()
 {
-    lws_callback_on_writable_all_protocol(context.get(), &protocols[1]);
+    for (size_t i = 1; i <= wsProtocolNames.size(); ++i)
+        lws_callback_on_writable_all_protocol(context.get(), &protocols[i]);
 }
 
 bool ServerContext::service(const int tsi, const int timeout_ms)
@@ -148,13 +184,40 @@ void ServerContext::service(PollDescriptors& pollDescriptors,
 void ServerContext::cancelService()
 {
     lws_cancel_service(context.get());
+#ifdef LWS_WITH_LIBUV
+#if LWS_LIBRARY_VERSION_NUMBER < 3000000
+    if (cancelAsync)
+        uv_async_send(cancelAsync);
+#endif
+#endif
+}
+
+void ServerContext::setCancelCallback(std::function<void()> callback)
+{
+    cancelCallback = std::move(callback);
 }
 
-void ServerContext::createWebsocketsProtocol(lws_callback_function* wsCallback,
-                                             void* user)
+void ServerContext::createWebsocketsProtocols(
+    const std::string& names, lws_callback_function* wsCallback,
+    const size_t sessionDataSize, void* user)
 {
-    protocols.insert(protocols.begin() + 1,
-                     make_protocol(wsProtocolName.c_str(), wsCallback, user));
+    // the names are referenced by the protocols, collect them all first
+    std::istringstream stream{names};
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        const auto begin = name.find_first_not_of(' ');
+        if (begin != std::string::npos)
+            wsProtocolNames.push_back(
+                name.substr(begin, name.find_last_not_of(' ') - begin + 1));
+    }
+
+    std::vector<lws_protocols> wsProtocols;
+    for (const auto& protocolName : wsProtocolNames)
+        wsProtocols.push_back(make_protocol(protocolName.c_str(), wsCallback,
+                                            user, sessionDataSize));
+    protocols.insert(protocols.begin() + 1, wsProtocols.begin(),
+                     wsProtocols.end());
 }
 
 void ServerContext::fillContextInfo(const std::string& uri,
@@ -167,6 +230,7 @@ void ServerContext::fillContextInfo(const std::string& uri,
         info.iface = interface.c_str();
     info.port = parsedUri.port;
     info.protocols = protocols.data();
+    info.extensions = websocket_extensions();
     info.gid = -1;
     info.uid = -1;
 #if USE_EXPLICIT_VHOST
@@ -28,9 +28,12 @@
 
 #include <libwebsockets.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
+struct uv_async_s;
+
 namespace rockets
 {
 /**
@@ -39,11 +42,19 @@ namespace rockets
 class ServerContext
 {
 public:
+    /**
+     * @param sessionDataSize size of the per-session user data that lws
+     *        allocates for each http connection.
+     * @param name of the websockets protocol, or comma-separated list of
+     *        protocol names which all share the same callback.
+     * @param wsSessionDataSize same for each websocket connection.
+     */
     ServerContext(const std::string& uri, const std::string& name,
                   const unsigned int threadCount,
-                  lws_callback_function* callback,
-                  lws_callback_function* wsCallback, void* user,
-                  void* uvLoop = nullptr);
+                  lws_callback_function* callback, size_t sessionDataSize,
+                  lws_callback_function* wsCallback, size_t wsSessionDataSize,
+                  void* user, void* uvLoop = nullptr);
+    ~ServerContext();
 
     std::string getHostname() const;
     uint16_t getPort() const;
@@ -57,17 +68,28 @@ public:
                  int events);
     void cancelService();
 
+    /**
+     * Set the function called by the libuv loop after cancelService().
+     *
+     * Only used with the libuv loops of libwebsockets < 3, which
+     * lws_cancel_service() does not wake up.
+     */
+    void setCancelCallback(std::function<void()> callback);
+
 private:
     std::string interface;
     lws_context_creation_info info;
     std::vector<lws_protocols> protocols;
-    std::string wsProtocolName;
+    std::vector<std::string> wsProtocolNames;
     LwsContextPtr context;
+    std::function<void()> cancelCallback;
+    uv_async_s* cancelAsync = nullptr;
 
     void fillContextInfo(const std::string& uri,
                          const unsigned int threadCount);
-    void createWebsocketsProtocol(lws_callback_function* wsCallback,
-                                  void* user);
+    void createWebsocketsProtocols(const std::string& names,
+                                   lws_callback_function* wsCallback,
+                                   size_t sessionDataSize, void* user);
 };
 }
 
@@ -19,29 +19,23 @@
 
 #include "serviceThreadPool.h"
 
-#ifdef __linux__
-#include <sys/prctl.h>
-#endif
+#include "utils.h"
 
 namespace
 {
-const auto serviceTimeoutMs = 50;
+// Service threads are woken up explicitly when needed, the timeout is only a
+// safety net for ensuring that the exit condition gets checked regularly.
+const auto serviceTimeoutMs = 1000;
 
-void setThreadName(const std::string& name)
-{
-#ifdef __APPLE__
-    pthread_setname_np(name.c_str());
-#elif defined(__linux__)
-    prctl(PR_SET_NAME, name.c_str(), 0, 0, 0);
-#endif
-}
+thread_local int currentThreadIndex = 0;
 }
 
 namespace rockets
 {
 ServiceThreadPool::ServiceThreadPool(ServerContext& context_)
     : context(context_)
-    , broadcastRequested{new std::atomic_bool[context.getThreadCount()]}
+    , broadcastRequested{new std::atomic_bool[context.getThreadCount()]()}
+    , taskQueues{new TaskQueue[context.getThreadCount()]}
 {
     start();
 }
@@ -60,15 +54,29 @@ void ServiceThreadPool::requestBroadcast()
 {
     for (size_t tsi = 0; tsi < getSize(); ++tsi)
         broadcastRequested[tsi] = true;
+    context.cancelService();
+}
+
+void ServiceThreadPool::post(const int tsi, TaskQueue::Task task)
+{
+    taskQueues[tsi].push(std::move(task));
+    context.cancelService();
+}
+
+void ServiceThreadPool::runTasks()
+{
+    taskQueues[currentThreadIndex].run();
+}
+
+int ServiceThreadPool::getCurrentThreadIndex()
+{
+    return currentThreadIndex;
 }
 
 void ServiceThreadPool::handleBroadcastRequest(const int tsi)
 {
-    if (broadcastRequested[tsi])
-    {
+    if (broadcastRequested[tsi].exchange(false))
         context.requestBroadcast();
-        broadcastRequested[tsi] = false;
-    }
 }
 
 void ServiceThreadPool::start()
@@ -78,8 +86,12 @@ void ServiceThreadPool::start()
         const auto name = "rockets_" + std::to_string(tsi);
         serviceThreads.emplace_back(std::thread([this, tsi, name]() {
             setThreadName(name);
+            currentThreadIndex = tsi;
             while (context.service(tsi, serviceTimeoutMs) && !exitService)
+            {
                 handleBroadcastRequest(tsi);
+                runTasks();
+            }
         }));
     }
 }
@@ -25,11 +25,15 @@
 #include <vector>
 
 #include <rockets/serverContext.h>
+#include <rockets/taskQueue.h>
 
 namespace rockets
 {
 /**
  * Service thread pool for the server.
+ *
+ * The service threads sleep until there is activity on their sockets or they
+ * are woken up by a request from another thread.
  */
 class ServiceThreadPool
 {
@@ -38,12 +42,24 @@ public:
     ~ServiceThreadPool();
 
     size_t getSize() const;
+
+    /** Wake up all service threads to write pending messages (thread-safe). */
     void requestBroadcast();
 
+    /** Run a task on the given service thread, once woken up (thread-safe). */
+    void post(int tsi, TaskQueue::Task task);
+
+    /** Run the tasks posted to the calling service thread. */
+    void runTasks();
+
+    /** @return the index of the calling service thread, 0 for other threads. */
+    static int getCurrentThreadIndex();
+
 private:
     ServerContext& context;
     std::vector<std::thread> serviceThreads;
     std::unique_ptr<std::atomic_bool[]> broadcastRequested;
+    std::unique_ptr<TaskQueue[]> taskQueues;
     std::atomic_bool exitService{false};
 
     void handleBroadcastRequest(int tsi);
@@ -0,0 +1,40 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "taskQueue.h"
+
+namespace rockets
+{
+void TaskQueue::push(Task task)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    _tasks.emplace_back(std::move(task));
+}
+
+void TaskQueue::run()
+{
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        tasks.swap(_tasks);
+    }
+    for (auto& task : tasks)
+        task();
+}
+}
@@ -0,0 +1,49 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_TASKQUEUE_H
+#define ROCKETS_TASKQUEUE_H
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace rockets
+{
+/**
+ * Queue of tasks to be run by a service thread, fed from any thread.
+ */
+class TaskQueue
+{
+public:
+    using Task = std::function<void()>;
+
+    /** Add a task to the queue (thread-safe). */
+    void push(Task task);
+
+    /** Run all pending tasks, in order. */
+    void run();
+
+private:
+    std::mutex _mutex;
+    std::vector<Task> _tasks;
+};
+}
+
+#endif
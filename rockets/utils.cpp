@@ -36,6 +36,11 @@
 #include <sys/socket.h>
 #endif
 
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <cstdlib>
 #include <vector>
 
 namespace rockets
@@ -59,11 +64,12 @@ Uri parse(const std::string& uri)
 }
 
 lws_protocols make_protocol(const char* name, lws_callback_function* callback,
-                            void* user)
+                            void* user, const size_t sessionDataSize)
 {
     // clang-format off
     const size_t rx_buffer_size = 1048576; // 1MB
-    return lws_protocols{ name, callback, 0, rx_buffer_size, 0, user
+    return lws_protocols{ name, callback, sessionDataSize, rx_buffer_size, 0,
+                          user
         #if LWS_LIBRARY_VERSION_NUMBER >= 2003000
                 , 0
         #endif
@@ -76,6 +82,19 @@ lws_protocols null_protocol()
     return make_protocol(nullptr, nullptr, nullptr);
 }
 
+const lws_extension* websocket_extensions()
+{
+#ifdef LWS_WITHOUT_EXTENSIONS
+    return nullptr;
+#else
+    static const lws_extension extensions[] = {
+        {"permessage-deflate", lws_extension_callback_pm_deflate,
+         "permessage-deflate; client_max_window_bits"},
+        {nullptr, nullptr, nullptr}};
+    return extensions;
+#endif
+}
+
 namespace
 {
 bool _isValidInterface(ifaddrs* interface)
@@ -190,4 +209,37 @@ std::string getHostname()
     host[NI_MAXHOST - 1] = '\0';
     return host;
 }
+
+void setThreadName(const std::string& name)
+{
+#ifdef __APPLE__
+    pthread_setname_np(name.c_str());
+#elif defined(__linux__)
+    prctl(PR_SET_NAME, name.c_str(), 0, 0, 0);
+#endif
+}
+
+std::FILE* createTempFile(std::string& path)
+{
+#ifdef _WIN32
+    char* name = _tempnam(nullptr, "rockets");
+    if (!name)
+        return nullptr;
+    path = name;
+    std::free(name);
+    return std::fopen(path.c_str(), "wb");
+#else
+    const char* tmpdir = std::getenv("TMPDIR");
+    path = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp");
+    path.append("/rockets_XXXXXX");
+    const int fd = mkstemp(&path[0]);
+    if (fd == -1)
+        return nullptr;
+    if (auto file = fdopen(fd, "wb"))
+        return file;
+    close(fd);
+    std::remove(path.c_str());
+    return nullptr;
+#endif
+}
 }
@@ -22,6 +22,7 @@
 
 #include <libwebsockets.h>
 
+#include <cstdio>
 #include <memory>
 #include <string>
 
@@ -37,13 +38,30 @@ struct Uri
 Uri parse(const std::string& uri);
 
 lws_protocols make_protocol(const char* name, lws_callback_function* callback,
-                            void* user);
+                            void* user, size_t sessionDataSize = 0);
 lws_protocols null_protocol();
 
+/**
+ * @return the websocket extensions supported by the contexts, nullptr if
+ *         libwebsockets was built without them. Their use is confirmed per
+ *         connection by the protocol callbacks.
+ */
+const lws_extension* websocket_extensions();
+
 std::string getIP(const std::string& iface);
 std::string getInterface(const std::string& hostnameOrIP);
 
 std::string getHostname();
+
+void setThreadName(const std::string& name);
+
+/**
+ * Create a new temporary file opened for writing.
+ *
+ * @param path set to the path of the file, which must be removed by the caller.
+ * @return the file, nullptr on error.
+ */
+std::FILE* createTempFile(std::string& path);
 }
 
 #endif
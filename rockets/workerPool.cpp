@@ -0,0 +1,84 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "workerPool.h"
+
+#include "utils.h"
+
+namespace rockets
+{
+WorkerPool::WorkerPool(const unsigned int threadCount,
+                       const size_t maxQueueSize_)
+    : maxQueueSize{maxQueueSize_}
+{
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        const auto name = "rockets_work_" + std::to_string(i);
+        workers.emplace_back(std::thread([this, name]() {
+            setThreadName(name);
+            run();
+        }));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        exit = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+size_t WorkerPool::getSize() const
+{
+    return workers.size();
+}
+
+bool WorkerPool::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (tasks.size() >= maxQueueSize)
+            return false;
+        tasks.emplace_back(std::move(task));
+    }
+    condition.notify_one();
+    return true;
+}
+
+void WorkerPool::run()
+{
+    for (;;)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            condition.wait(lock, [this] { return exit || !tasks.empty(); });
+            if (exit)
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_WORKERPOOL_H
+#define ROCKETS_WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rockets
+{
+/**
+ * Pool of worker threads executing tasks from a bounded queue.
+ *
+ * Pending tasks are discarded when the pool is destroyed.
+ */
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+
+    WorkerPool(unsigned int threadCount, size_t maxQueueSize);
+    ~WorkerPool();
+
+    size_t getSize() const;
+
+    /**
+     * Queue a task for execution.
+     *
+     * @param task to execute on one of the worker threads.
+     * @return false if the queue is full and the task was rejected.
+     */
+    bool post(Task task);
+
+private:
+    const size_t maxQueueSize;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Task> tasks;
+    std::vector<std::thread> workers;
+    bool exit = false;
+
+    void run();
+};
+}
+
+#endif
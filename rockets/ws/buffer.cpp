@@ -0,0 +1,48 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "buffer.h"
+
+#include <libwebsockets.h>
+
+#include <cstring> // memcpy
+
+namespace rockets
+{
+namespace ws
+{
+Buffer::Buffer(const char* data, const size_t size)
+    : _data{new unsigned char[LWS_PRE + size]}
+    , _size{size}
+{
+    if (size > 0)
+        std::memcpy(payload(), data, size);
+}
+
+Buffer::Buffer(const std::string& data)
+    : Buffer(data.data(), data.size())
+{
+}
+
+unsigned char* Buffer::payload() const
+{
+    return _data.get() + LWS_PRE;
+}
+}
+}
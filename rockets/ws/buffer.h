@@ -0,0 +1,66 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_WS_BUFFER_H
+#define ROCKETS_WS_BUFFER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace rockets
+{
+namespace ws
+{
+/**
+ * Immutable payload of an outgoing websocket message.
+ *
+ * The payload is stored once, preceded by the headroom that lws_write() needs
+ * for the frame header. The same buffer can thus be queued on any number of
+ * connections and written to each of them without being copied.
+ */
+class Buffer
+{
+public:
+    Buffer(const char* data, size_t size);
+    explicit Buffer(const std::string& data);
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    /** @return the payload, preceded by LWS_PRE bytes of headroom. */
+    unsigned char* payload() const;
+
+    /**
+     * Mutex to lock while writing the payload, as lws_write() modifies the
+     * headroom and connections can be served by different threads.
+     */
+    std::mutex& getWriteMutex() const { return _writeMutex; }
+
+private:
+    std::unique_ptr<unsigned char[]> _data;
+    size_t _size = 0;
+    mutable std::mutex _writeMutex;
+};
+
+using BufferPtr = std::shared_ptr<const Buffer>;
+}
+}
+
+#endif
@@ -19,6 +19,15 @@
 
 #include "channel.h"
 
+#include "buffer.h"
+
+#include <algorithm>
+#include <string>
+
+#if LWS_LIBRARY_VERSION_NUMBER >= 2000000 && !defined(LWS_WITHOUT_EXTENSIONS)
+#define CAN_SET_EXTENSION_OPTION 1
+#endif
+
 namespace rockets
 {
 namespace ws
@@ -29,6 +38,14 @@ lws_write_protocol _getProtocol(const Format format)
 {
     return format == Format::text ? LWS_WRITE_TEXT : LWS_WRITE_BINARY;
 }
+
+#if CAN_SET_EXTENSION_OPTION
+const char* DEFLATE_EXTENSION = "permessage-deflate";
+
+// zlib does not support raw deflate with windows of 256 bytes (8 bits)
+const int MIN_WINDOW_BITS = 9;
+const int MAX_WINDOW_BITS = 15;
+#endif
 }
 
 Channel::Channel(lws* wsi_)
@@ -61,13 +78,55 @@ size_t Channel::getCurrentMessageRemainingSize() const
     return lws_remaining_packet_payload(wsi);
 }
 
-void Channel::write(std::string&& message, const Format format)
+std::string Channel::getProtocol() const
+{
+    const auto protocol = lws_get_protocol(wsi);
+    return protocol && protocol->name ? protocol->name : std::string();
+}
+
+void Channel::write(const Buffer& message, const Format format)
 {
-    const auto size = message.size();
-    message.insert(0, LWS_PRE, '0');
-    auto data = (unsigned char*)(&message.data()[LWS_PRE]);
     const auto protocol = _getProtocol(format);
-    lws_write(wsi, data, size, protocol);
+    std::lock_guard<std::mutex> lock{message.getWriteMutex()};
+    lws_write(wsi, message.payload(), message.size(), protocol);
+}
+
+void Channel::setCloseStatus(const lws_close_status status)
+{
+    lws_close_reason(wsi, status, nullptr, 0);
+}
+
+void Channel::close(const lws_close_status status)
+{
+    setCloseStatus(status);
+#ifdef LWS_TO_KILL_ASYNC
+    lws_set_timeout(wsi, PENDING_TIMEOUT_CLOSE_SEND, LWS_TO_KILL_ASYNC);
+#else
+    lws_set_timeout(wsi, PENDING_TIMEOUT_CLOSE_SEND, 1);
+#endif
+}
+
+void Channel::setCompression(const CompressionOptions& options,
+                             const bool server)
+{
+#if CAN_SET_EXTENSION_OPTION
+    // Only the window of the outgoing messages can be reduced after the
+    // handshake, the peer inflates them with the negotiated (larger) one.
+    const auto windowBits = std::min(
+        std::max(options.windowBits, MIN_WINDOW_BITS), MAX_WINDOW_BITS);
+    const auto window = std::to_string(windowBits);
+    const auto level = std::to_string(std::min(std::max(options.level, 1), 9));
+    const auto windowOption =
+        server ? "server_max_window_bits" : "client_max_window_bits";
+    // fails if the extension was not negotiated with the peer
+    compressed = lws_set_extension_option(wsi, DEFLATE_EXTENSION, windowOption,
+                                          window.c_str()) == 0;
+    lws_set_extension_option(wsi, DEFLATE_EXTENSION, "compression_level",
+                             level.c_str());
+#else
+    (void)options;
+    (void)server;
+#endif
 }
 }
 }
@@ -28,6 +28,8 @@ namespace rockets
 {
 namespace ws
 {
+class Buffer;
+
 /**
  * A WebSocket communication channel.
  *
@@ -42,12 +44,37 @@ public:
     bool currentMessageHasMore() const;
     size_t getCurrentMessageRemainingSize() const;
 
+    /** @return the name of the websocket protocol of the connection. */
+    std::string getProtocol() const;
+
     void requestWrite();
     bool canWrite() const;
-    void write(std::string&& message, Format format);
+    void write(const Buffer& message, Format format);
+
+    /** Set the status code to close the connection with. */
+    void setCloseStatus(lws_close_status status);
+
+    /**
+     * Close the connection with the given status without waiting for it to be
+     * writable. Must be called from the thread serving the connection.
+     */
+    void close(lws_close_status status);
+
+    /**
+     * Set the compression of the outgoing messages, if permessage-deflate was
+     * negotiated. Must be called before writing the first message.
+     *
+     * @param options for the compression.
+     * @param server true on the server side of the connection.
+     */
+    void setCompression(const CompressionOptions& options, bool server);
+
+    /** @return true if setCompression() found permessage-deflate active. */
+    bool isCompressed() const { return compressed; }
 
 private:
     lws* wsi = nullptr;
+    bool compressed = false;
 };
 }
 }
@@ -29,6 +29,7 @@
 namespace
 {
 const char* wsProtocolNotFound = "unsupported websocket protocol";
+const std::string DEFLATE_EXTENSION = "permessage-deflate";
 
 template <typename PromiseT>
 void tryToSetException(PromiseT& promise, std::exception_ptr exception)
@@ -63,6 +64,11 @@ public:
         tryToSetException(connectionPromise, std::current_exception());
     }
 
+    bool offersExtension(const char* name) const
+    {
+        return compressionEnabled && name && name == DEFLATE_EXTENSION;
+    }
+
     PollDescriptors pollDescriptors;
 
     std::promise<void> connectionPromise;
@@ -70,6 +76,10 @@ public:
 
     MessageHandler messageHandler;
 
+    bool compressionEnabled = false;
+    CompressionOptions compression;
+    bool compressed = false;
+
     std::unique_ptr<ClientContext> context; // must be destructed first
 };
 
@@ -87,6 +97,7 @@ std::future<void> Client::connect(const std::string& uri,
 {
     try
     {
+        _impl->compressed = false;
         _impl->connection = _impl->context->connect(uri, protocol);
     }
     catch (...)
@@ -96,6 +107,27 @@ std::future<void> Client::connect(const std::string& uri,
     return _impl->connectionPromise.get_future();
 }
 
+bool Client::setCompression(const CompressionOptions& options)
+{
+    _impl->compressionEnabled = false;
+    if (!websocket_extensions())
+        return false;
+
+    _impl->compression = options;
+    _impl->compressionEnabled = options.level > 0;
+    return true;
+}
+
+bool Client::isCompressed() const
+{
+    return _impl->compressed;
+}
+
+void Client::setMaxMessageSize(const size_t size)
+{
+    _impl->messageHandler.maxMessageSize = size;
+}
+
 void Client::sendText(std::string message)
 {
     _impl->connection->sendText(std::move(message));
@@ -154,7 +186,15 @@ static int callback_ws(lws* wsi, lws_callback_reasons reason, void* /*user*/,
         auto client = static_cast<Client::Impl*>(protocol->user);
         switch (reason)
         {
+        case LWS_CALLBACK_CLIENT_CONFIRM_EXTENSION_SUPPORTED:
+            return client->offersExtension((const char*)in) ? 0 : 1;
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            if (client->compressionEnabled)
+            {
+                Channel channel{wsi};
+                channel.setCompression(client->compression, false);
+                client->compressed = channel.isCompressed();
+            }
             client->connectionPromise.set_value();
             break;
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
@@ -166,8 +206,11 @@ static int callback_ws(lws* wsi, lws_callback_reasons reason, void* /*user*/,
         }
 
         case LWS_CALLBACK_CLIENT_RECEIVE:
-            client->messageHandler.handleMessage(client->connection,
-                                                 (const char*)in, len);
+            if (!client->messageHandler.handleMessage(client->connection,
+                                                      (const char*)in, len))
+            {
+                return -1; // close the connection
+            }
             break;
         case LWS_CALLBACK_CLIENT_WRITEABLE:
             client->connection->writeMessages();
@@ -51,6 +51,33 @@ public:
      */
     ROCKETS_API std::future<void> connect(const std::string& uri,
                                           const std::string& protocol);
+
+    /**
+     * Offer to compress the messages with permessage-deflate. Disabled by
+     * default.
+     *
+     * Must be called before connect().
+     *
+     * @param options for compressing the messages, level 0 to disable.
+     * @return false if libwebsockets was built without extension support.
+     */
+    ROCKETS_API bool setCompression(const CompressionOptions& options);
+
+    /**
+     * @return true if the messages are compressed with permessage-deflate on
+     *         the established connection.
+     */
+    ROCKETS_API bool isCompressed() const;
+
+    /**
+     * Limit the size of incoming messages. Unlimited by default.
+     *
+     * The connection is closed with status 1009 (message too big) when the
+     * server sends a bigger message.
+     *
+     * @param size the maximum size of a message in bytes, 0 for unlimited.
+     */
+    ROCKETS_API void setMaxMessageSize(size_t size);
     //@}
 
     /** Send a text message to the websocket server. */
@@ -21,12 +21,18 @@
 
 #include "channel.h"
 
+#include <algorithm>
+
 namespace rockets
 {
 namespace ws
 {
-Connection::Connection(std::unique_ptr<Channel> channel_)
+Connection::Connection(std::unique_ptr<Channel> channel_,
+                       const QueueOptions& queueOptions_,
+                       OverflowCallback overflowCallback_)
     : channel{std::move(channel_)}
+    , queueOptions(queueOptions_)
+    , overflowCallback{std::move(overflowCallback_)}
 {
 }
 
@@ -42,23 +48,77 @@ void Connection::sendBinary(std::string message)
     channel->requestWrite();
 }
 
-void Connection::writeMessages()
+void Connection::send(BufferPtr message, const Format format)
+{
+    enqueue(std::move(message), format);
+    channel->requestWrite();
+}
+
+bool Connection::writeMessages()
 {
+    {
+        std::lock_guard<std::mutex> lock{outMutex};
+        if (overflowed)
+        {
+            channel->setCloseStatus(LWS_CLOSE_STATUS_POLICY_VIOLATION);
+            return false;
+        }
+    }
+
     while (hasMessage() && channel->canWrite())
         writeOneMessage();
 
     if (hasMessage())
         channel->requestWrite();
+    return true;
 }
 
 void Connection::enqueueText(std::string message)
 {
-    out.emplace_back(std::move(message), Format::text);
+    enqueue(std::make_shared<Buffer>(message), Format::text);
 }
 
 void Connection::enqueueBinary(std::string message)
 {
-    out.emplace_back(std::move(message), Format::binary);
+    enqueue(std::make_shared<Buffer>(message), Format::binary);
+}
+
+bool Connection::enqueue(BufferPtr message, const Format format,
+                         const std::string& key)
+{
+    std::lock_guard<std::mutex> lock{outMutex};
+    return push(std::move(message), format, key);
+}
+
+bool Connection::conflate(BufferPtr message, const Format format,
+                          const std::string& key)
+{
+    // replace or append atomically, so that concurrent messages with the same
+    // key never end up queued together
+    std::lock_guard<std::mutex> lock{outMutex};
+    if (!overflowed)
+    {
+        const auto queued = findQueued(key);
+        if (queued != out.end())
+            return replace(queued, std::move(message), format);
+    }
+    return push(std::move(message), format, key);
+}
+
+void Connection::closeMessageTooBig()
+{
+    channel->setCloseStatus(LWS_CLOSE_STATUS_MESSAGE_TOO_LARGE);
+}
+
+void Connection::closeOverflowed()
+{
+    channel->close(LWS_CLOSE_STATUS_POLICY_VIOLATION);
+}
+
+QueueStats Connection::getQueueStats() const
+{
+    std::lock_guard<std::mutex> lock{outMutex};
+    return stats;
 }
 
 const Channel& Connection::getChannel() const
@@ -66,16 +126,143 @@ const Channel& Connection::getChannel() const
     return *channel;
 }
 
+bool Connection::push(BufferPtr message, const Format format,
+                      const std::string& key)
+{
+    const auto size = message->size();
+    if (overflowed)
+    {
+        ++stats.dropped;
+        return false;
+    }
+
+    if (!fits(size))
+    {
+        switch (queueOptions.policy)
+        {
+        case OverflowPolicy::dropNewest:
+            ++stats.dropped;
+            return false;
+        case OverflowPolicy::disconnect:
+            overflow();
+            return false;
+        case OverflowPolicy::coalesce:
+        {
+            const auto queued = findQueued(key);
+            if (queued != out.end())
+                return replace(queued, std::move(message), format);
+        }
+        // fall-through
+        case OverflowPolicy::dropOldest:
+            while (!fits(size))
+                drop(0);
+            break;
+        }
+    }
+
+    out.push_back(Message{std::move(message), format, key});
+    ++stats.messages;
+    stats.bytes += size;
+    return true;
+}
+
 bool Connection::hasMessage() const
 {
+    std::lock_guard<std::mutex> lock{outMutex};
     return !out.empty();
 }
 
 void Connection::writeOneMessage()
 {
-    auto& message = out.at(0);
-    channel->write(std::move(message.first), message.second);
-    out.pop_front();
+    Message message;
+    {
+        std::lock_guard<std::mutex> lock{outMutex};
+        message = std::move(out.at(0));
+        out.pop_front();
+        --stats.messages;
+        stats.bytes -= message.buffer->size();
+        ++stats.sent;
+    }
+    channel->write(*message.buffer, message.format);
+}
+
+bool Connection::fits(const size_t size) const
+{
+    const auto& limits = queueOptions;
+    if (out.empty())
+        return true;
+    return (limits.maxMessages == 0 || out.size() < limits.maxMessages) &&
+           (limits.maxBytes == 0 || stats.bytes + size <= limits.maxBytes);
+}
+
+std::deque<Connection::Message>::iterator Connection::findQueued(
+    const std::string& key)
+{
+    if (key.empty())
+        return out.end();
+
+    return std::find_if(out.begin(), out.end(), [&key](const Message& queued) {
+        return queued.key == key;
+    });
+}
+
+bool Connection::replace(const std::deque<Message>::iterator queued,
+                         BufferPtr message, const Format format)
+{
+    // the message takes the slot of the queued one, only its size may not fit
+    const auto maxBytes = queueOptions.maxBytes;
+    const auto bytes = stats.bytes - queued->buffer->size() + message->size();
+    if (maxBytes > 0 && bytes > maxBytes && out.size() > 1)
+    {
+        switch (queueOptions.policy)
+        {
+        case OverflowPolicy::dropNewest:
+            ++stats.dropped;
+            return false;
+        case OverflowPolicy::disconnect:
+            overflow();
+            return false;
+        case OverflowPolicy::coalesce:
+        case OverflowPolicy::dropOldest:
+            break;
+        }
+    }
+
+    // keep the position in the queue, with the newest value
+    auto index = static_cast<size_t>(queued - out.begin());
+    queued->buffer = std::move(message);
+    queued->format = format;
+    stats.bytes = bytes;
+    ++stats.dropped;
+
+    // then make room by dropping the oldest of the other messages
+    while (maxBytes > 0 && stats.bytes > maxBytes && out.size() > 1)
+    {
+        const size_t oldest = index == 0 ? 1 : 0;
+        drop(oldest);
+        if (oldest < index)
+            --index;
+    }
+    return true;
+}
+
+void Connection::drop(const size_t index)
+{
+    stats.bytes -= out[index].buffer->size();
+    --stats.messages;
+    ++stats.dropped;
+    out.erase(out.begin() + index);
+}
+
+void Connection::overflow()
+{
+    stats.dropped += out.size() + 1;
+    stats.messages = 0;
+    stats.bytes = 0;
+    out.clear();
+    overflowed = true;
+    if (overflowCallback)
+        overflowCallback(clientID);
 }
 }
 }
@@ -20,10 +20,12 @@
 #ifndef ROCKETS_WS_CONNECTION_H
 #define ROCKETS_WS_CONNECTION_H
 
+#include <rockets/ws/buffer.h>
 #include <rockets/ws/types.h>
 
 #include <deque>
 #include <memory>
+#include <mutex>
 
 namespace rockets
 {
@@ -33,11 +35,25 @@ class Channel;
 
 /**
  * A WebSocket connection.
+ *
+ * Messages can be queued from any thread, they are written by the thread
+ * serving the connection. The queue can be bounded, in which case messages
+ * are dropped or the connection is closed according to its OverflowPolicy.
  */
 class Connection
 {
 public:
-    explicit Connection(std::unique_ptr<Channel> channel);
+    /**
+     * Called when the queue overflows with the disconnect policy, from the
+     * thread queuing the message and with the queue locked. It must arrange
+     * for closeOverflowed() to be called from the thread serving the
+     * connection, whose socket may never become writable again.
+     */
+    using OverflowCallback = std::function<void(uintptr_t clientID)>;
+
+    explicit Connection(std::unique_ptr<Channel> channel,
+                        const QueueOptions& queueOptions = QueueOptions(),
+                        OverflowCallback overflowCallback = OverflowCallback());
 
     /** Send a text message (will be queued for later processing). */
     void sendText(std::string message);
@@ -45,8 +61,14 @@ public:
     /** Send a binary message (will be queued for later processing). */
     void sendBinary(std::string message);
 
-    /** Write all pending messages. */
-    void writeMessages();
+    /** Send a shared message (will be queued for later processing). */
+    void send(BufferPtr message, Format format);
+
+    /**
+     * Write all pending messages.
+     * @return false if the connection must be closed.
+     */
+    bool writeMessages();
 
     /** Enqueue a text message. */
     void enqueueText(std::string message);
@@ -54,15 +76,74 @@ public:
     /** Enqueue a binary message. */
     void enqueueBinary(std::string message);
 
+    /**
+     * Enqueue a shared message, which is written without being copied.
+     *
+     * @param message to enqueue.
+     * @param format of the message.
+     * @param key identifying the message for the coalesce OverflowPolicy,
+     *        empty if none.
+     * @return false if the message was dropped.
+     */
+    bool enqueue(BufferPtr message, Format format,
+                 const std::string& key = std::string());
+
+    /**
+     * Enqueue a shared message, replacing the queued one with the same key
+     * instead of appending, so that only the latest value gets written.
+     *
+     * @return false if the message was dropped.
+     */
+    bool conflate(BufferPtr message, Format format, const std::string& key);
+
+    /** @return the counters of the queue of outgoing messages. */
+    QueueStats getQueueStats() const;
+
     /** @internal*. */
     const Channel& getChannel() const;
 
+    /** @internal Buffer to reassemble the fragments of incoming messages. */
+    std::string& getReceiveBuffer() { return inBuffer; }
+
+    /** @internal Close with status 1009 after receiving a too big message. */
+    void closeMessageTooBig();
+
+    /** @internal Close with status 1008 after overflowing the queue. */
+    void closeOverflowed();
+
+    /** @return the ID of the client, assigned by the server. */
+    uintptr_t getClientID() const { return clientID; }
+
+    /** @internal */
+    void setClientID(const uintptr_t id) { clientID = id; }
+
 private:
     std::unique_ptr<Channel> channel;
-    std::deque<std::pair<std::string, Format>> out;
+    uintptr_t clientID = 0;
+    const QueueOptions queueOptions;
+    const OverflowCallback overflowCallback;
+    std::string inBuffer;
+
+    struct Message
+    {
+        BufferPtr buffer;
+        Format format;
+        std::string key;
+    };
+    mutable std::mutex outMutex;
+    std::deque<Message> out;
+    QueueStats stats;
+    bool overflowed = false;
 
     bool hasMessage() const;
     void writeOneMessage();
+    bool push(BufferPtr message, Format format, const std::string& key);
+    bool fits(size_t size) const;
+    std::deque<Message>::iterator findQueued(const std::string& key);
+    bool replace(std::deque<Message>::iterator queued, BufferPtr message,
+                 Format format);
+    void drop(size_t index);
+    void overflow();
 };
 }
 }
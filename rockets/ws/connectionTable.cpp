@@ -0,0 +1,137 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "connectionTable.h"
+
+#include "connection.h"
+
+#include <stdexcept>
+
+namespace rockets
+{
+namespace ws
+{
+namespace
+{
+// low half of the client ID is the slot, high half is the generation
+constexpr auto slotBits = sizeof(uintptr_t) * 4;
+constexpr auto slotMask = (uintptr_t{1} << slotBits) - 1;
+
+size_t getSlot(const uintptr_t clientID)
+{
+    return clientID & slotMask;
+}
+
+uintptr_t makeClientID(const size_t slot, const uintptr_t generation)
+{
+    return (generation << slotBits) | slot;
+}
+}
+
+ConnectionPtr ConnectionTable::Data::findClient(const uintptr_t clientID) const
+{
+    const auto slot = getSlot(clientID);
+    if (slot >= slots.size() || !slots[slot] ||
+        slots[slot]->getClientID() != clientID)
+    {
+        return nullptr;
+    }
+    return slots[slot];
+}
+
+std::vector<bool> ConnectionTable::Data::getSlotMask(
+    const std::set<uintptr_t>& ids) const
+{
+    std::vector<bool> mask(slots.size(), false);
+    for (const auto id : ids)
+    {
+        if (findClient(id))
+            mask[getSlot(id)] = true;
+    }
+    return mask;
+}
+
+ConnectionTable::ConnectionTable()
+    : _snapshot{std::make_shared<const Data>()}
+{
+}
+
+ConnectionTable::Snapshot ConnectionTable::getSnapshot() const
+{
+    return std::atomic_load(&_snapshot);
+}
+
+ConnectionPtr ConnectionTable::findClient(const uintptr_t clientID) const
+{
+    return getSnapshot()->findClient(clientID);
+}
+
+size_t ConnectionTable::size() const
+{
+    return getSnapshot()->connections.size();
+}
+
+void ConnectionTable::add(lws* wsi, ConnectionPtr connection)
+{
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    auto data = std::make_shared<Data>(*_snapshot);
+
+    size_t slot = 0;
+    if (_freeSlots.empty())
+    {
+        slot = data->slots.size();
+        if (slot > slotMask)
+            throw std::runtime_error("too many websocket connections");
+        data->slots.emplace_back();
+        _generations.emplace_back(0);
+    }
+    else
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    // generation 0 is skipped so that client IDs are never 0
+    auto& generation = _generations[slot];
+    if (++generation > slotMask)
+        generation = 1;
+
+    connection->setClientID(makeClientID(slot, generation));
+    data->slots[slot] = connection;
+    data->connections.emplace(wsi, std::move(connection));
+    std::atomic_store(&_snapshot, Snapshot{std::move(data)});
+}
+
+ConnectionPtr ConnectionTable::remove(lws* wsi)
+{
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    const auto it = _snapshot->connections.find(wsi);
+    if (it == _snapshot->connections.end())
+        return nullptr;
+
+    auto connection = it->second;
+    const auto slot = getSlot(connection->getClientID());
+    auto data = std::make_shared<Data>(*_snapshot);
+    data->connections.erase(wsi);
+    data->slots[slot] = nullptr;
+    _freeSlots.push_back(slot);
+    std::atomic_store(&_snapshot, Snapshot{std::move(data)});
+    return connection;
+}
+}
+}
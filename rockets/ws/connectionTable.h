@@ -0,0 +1,97 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_WS_CONNECTIONTABLE_H
+#define ROCKETS_WS_CONNECTIONTABLE_H
+
+#include <rockets/ws/types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+struct lws;
+
+namespace rockets
+{
+namespace ws
+{
+using Connections = std::map<lws*, ConnectionPtr>;
+
+/**
+ * Table of open websocket connections, read-mostly.
+ *
+ * Readers get an immutable snapshot of the table without taking a lock, so
+ * that receiving on several service threads and broadcasting never contend.
+ * Writers (connection open/close) copy the table and publish the new version.
+ *
+ * Each connection is assigned a slot and a client ID made of the slot index
+ * and a generation counter, which is incremented every time the slot is
+ * reused. Client IDs thus resolve to connections in constant time and the ID
+ * of a closed connection never addresses a newer one (until the generation
+ * counter wraps around).
+ */
+class ConnectionTable
+{
+public:
+    struct Data
+    {
+        /** @return the connection for the given client, nullptr if closed. */
+        ConnectionPtr findClient(uintptr_t clientID) const;
+
+        /** @return the mask of the slots used by the given clients. */
+        std::vector<bool> getSlotMask(const std::set<uintptr_t>& ids) const;
+
+        /** The connections indexed by lws handle. */
+        Connections connections;
+
+        /** The connections indexed by slot, nullptr for free slots. */
+        std::vector<ConnectionPtr> slots;
+    };
+    using Snapshot = std::shared_ptr<const Data>;
+
+    ConnectionTable();
+
+    /** @return the current connections, unaffected by later changes. */
+    Snapshot getSnapshot() const;
+
+    /** @return the connection for the given client, nullptr if not found. */
+    ConnectionPtr findClient(uintptr_t clientID) const;
+
+    /** @return the number of connections. */
+    size_t size() const;
+
+    /** Add a connection and assign its client ID. */
+    void add(lws* wsi, ConnectionPtr connection);
+
+    /** Remove a connection. @return the removed connection, or nullptr. */
+    ConnectionPtr remove(lws* wsi);
+
+private:
+    Snapshot _snapshot;
+    std::mutex _writeMutex;
+    std::vector<uintptr_t> _generations;
+    std::vector<size_t> _freeSlots;
+};
+}
+}
+
+#endif
@@ -28,53 +28,80 @@ namespace rockets
 {
 namespace ws
 {
-Connections MessageHandler::_emptyConnections{};
+ConnectionTable MessageHandler::_emptyConnections{};
 
-MessageHandler::MessageHandler(const Connections& connections)
+MessageHandler::MessageHandler(const ConnectionTable& connections)
     : _connections(connections)
 {
 }
 
-void MessageHandler::handleMessage(ConnectionPtr connection, const char* data,
+bool MessageHandler::handleMessage(ConnectionPtr connection, const char* data,
                                    const size_t len)
 {
-    // compose potentially fragmented message
-    if (connection->getChannel().currentMessageHasMore() && _buffer.empty())
+    const auto& channel = connection->getChannel();
+    auto& buffer = connection->getReceiveBuffer();
+    const auto remaining = channel.getCurrentMessageRemainingSize();
+
+    // reject a message as soon as it is known to be too big, before buffering
+    if (maxMessageSize > 0 && buffer.size() + len + remaining > maxMessageSize)
     {
-        _buffer.reserve(
-            len + connection->getChannel().getCurrentMessageRemainingSize());
+        buffer.clear();
+        connection->closeMessageTooBig();
+        return false;
     }
-    _buffer.append(data, len);
-    if (connection->getChannel().currentMessageHasMore())
-        return;
 
-    const auto clientID = reinterpret_cast<uintptr_t>(connection.get());
-    const Format format = connection->getChannel().getCurrentMessageFormat();
+    std::string message;
+    if (buffer.empty() && !channel.currentMessageHasMore())
+        message.assign(data, len);
+    else
+    {
+        // compose fragmented message, reserving the size known so far; the
+        // buffer is then moved, not copied, to the message for the callbacks
+        if (buffer.empty())
+            buffer.reserve(len + remaining);
+        buffer.append(data, len);
+        if (channel.currentMessageHasMore())
+            return true;
+        message = std::move(buffer);
+        buffer.clear();
+    }
+
+    const auto clientID = connection->getClientID();
+    const auto protocol = channel.getProtocol();
+    const Format format = channel.getCurrentMessageFormat();
     Response response;
-    if (format == Format::text)
     {
-        if (callbackText)
-            response = callbackText({std::move(_buffer), clientID});
-        else if (callbackTextAsync)
+        std::lock_guard<std::mutex> lock{_callbackMutex};
+        if (format == Format::text)
         {
-            callbackTextAsync({std::move(_buffer), clientID},
-                              [weak = std::weak_ptr<Connection>(connection)](
-                                  const auto& reply) {
-                                  auto conn = weak.lock();
-                                  if (conn && !reply.empty())
-                                      conn->sendText(std::move(reply));
-                              });
-            return;
+            if (callbackText)
+                response =
+                    callbackText({std::move(message), clientID, protocol});
+            else if (callbackTextAsync)
+            {
+                callbackTextAsync({std::move(message), clientID, protocol},
+                                  _makeResponseCallback(connection, format));
+                return true;
+            }
+        }
+        else if (format == Format::binary)
+        {
+            if (callbackBinary)
+                response =
+                    callbackBinary({std::move(message), clientID, protocol});
+            else if (callbackBinaryAsync)
+            {
+                callbackBinaryAsync({std::move(message), clientID, protocol},
+                                    _makeResponseCallback(connection, format));
+                return true;
+            }
         }
     }
-    else if (format == Format::binary && callbackBinary)
-        response = callbackBinary({std::move(_buffer), clientID});
-
-    _buffer.clear();
 
     if (response.format == Format::unspecified)
         response.format = format;
     _sendResponseToRecipient(response, connection);
+    return true;
 }
 
 void MessageHandler::handleOpenConnection(ConnectionPtr connection)
@@ -82,8 +109,12 @@ void MessageHandler::handleOpenConnection(ConnectionPtr connection)
     if (!callbackOpen)
         return;
 
-    const auto clientID = reinterpret_cast<uintptr_t>(connection.get());
-    auto responses = callbackOpen(clientID);
+    const auto clientID = connection->getClientID();
+    std::vector<Response> responses;
+    {
+        std::lock_guard<std::mutex> lock{_callbackMutex};
+        responses = callbackOpen(clientID);
+    }
     for (auto& response : responses)
         _sendResponseToRecipient(response, connection);
 }
@@ -93,52 +124,64 @@ void MessageHandler::handleCloseConnection(ConnectionPtr connection)
     if (!callbackClose)
         return;
 
-    const auto clientID = reinterpret_cast<uintptr_t>(connection.get());
-    auto responses = callbackClose(clientID);
+    const auto clientID = connection->getClientID();
+    std::vector<Response> responses;
+    {
+        std::lock_guard<std::mutex> lock{_callbackMutex};
+        responses = callbackClose(clientID);
+    }
     for (auto& response : responses)
         _sendResponseToRecipient(response, connection);
 }
 
-void sendResponse(const Response& response, Connection& connection)
+ResponseCallback MessageHandler::_makeResponseCallback(ConnectionPtr connection,
+                                                      const Format format) const
 {
-    switch (response.format)
+    return [ weak = std::weak_ptr<Connection>(connection), format,
+             wakeup = callbackWakeup ](std::string reply)
     {
-    case Format::unspecified:
-        break;
-    case Format::binary:
-        connection.sendBinary(std::move(response.message));
-        break;
-    case Format::text:
-    default:
-        connection.sendText(std::move(response.message));
-    }
+        auto conn = weak.lock();
+        if (!conn || reply.empty())
+            return;
+        auto message = std::make_shared<Buffer>(reply);
+        if (wakeup)
+        {
+            conn->enqueue(std::move(message), format);
+            wakeup();
+        }
+        else
+            conn->send(std::move(message), format);
+    };
 }
 
 void MessageHandler::_sendResponseToRecipient(const Response& response,
                                               ConnectionPtr sender)
 {
-    if (response.message.empty())
+    if (response.message.empty() || response.format == Format::unspecified)
         return;
 
+    // a single buffer is shared by all the recipients
+    const auto message = std::make_shared<Buffer>(response.message);
+
     switch (response.recipient)
     {
     case Recipient::all:
     case Recipient::others:
     {
-        for (const auto& connection : _connections)
+        for (const auto& connection : _connections.getSnapshot()->connections)
         {
             if (response.recipient == Recipient::others &&
                 connection.second == sender)
             {
                 continue;
             }
-            sendResponse(response, *connection.second);
+            connection.second->send(message, response.format);
         }
         break;
     }
     case Recipient::sender:
     default:
-        sendResponse(response, *sender);
+        sender->send(message, response.format);
     }
 }
 }
@@ -20,25 +20,26 @@
 #ifndef ROCKETS_WS_MESSAGEHANDLER_H
 #define ROCKETS_WS_MESSAGEHANDLER_H
 
+#include <rockets/ws/connectionTable.h>
 #include <rockets/ws/types.h>
 
-#include <libwebsockets.h>
-#include <map>
+#include <mutex>
 
 namespace rockets
 {
 namespace ws
 {
-using Connections = std::map<lws*, ConnectionPtr>;
-
 /**
  * Handle message callbacks for text/binary messages.
+ *
+ * The connections can be handled from multiple threads, but the callbacks are
+ * never called concurrently so they need no synchronization of their own.
  */
 class MessageHandler
 {
 public:
     MessageHandler() = default;
-    MessageHandler(const Connections& connections);
+    MessageHandler(const ConnectionTable& connections);
 
     /**
      * Handle a new connection.
@@ -57,11 +58,17 @@ public:
     /**
      * Handle an incomming message for the given connection.
      *
+     * Fragmented messages are reassembled in the buffer of the connection.
+     *
      * @param connection the connection to use for reply.
      * @param data the incoming data pointer.
      * @param len the length of the data.
+     * @return false if the message is too big, the connection must be closed.
      */
-    void handleMessage(ConnectionPtr connection, const char* data, size_t len);
+    bool handleMessage(ConnectionPtr connection, const char* data, size_t len);
+
+    /** The maximum size of incoming messages in bytes, 0 for unlimited. */
+    size_t maxMessageSize = 0;
 
     /** The callback for incoming connections. */
     ConnectionCallback callbackOpen;
@@ -78,13 +85,26 @@ public:
     /** The callback for messages in binary format. */
     MessageCallback callbackBinary;
 
+    /** The callback for messages in binary format with async response. */
+    MessageCallbackAsync callbackBinaryAsync;
+
+    /**
+     * The callback for waking up the service after an async response has been
+     * queued, possibly from another thread. If not set, the write is requested
+     * directly on the connection, which is only safe from the service thread.
+     */
+    std::function<void()> callbackWakeup;
+
 private:
+    ResponseCallback _makeResponseCallback(ConnectionPtr connection,
+                                           Format format) const;
     void _sendResponseToRecipient(const Response& response,
                                   ConnectionPtr connection);
 
-    static Connections _emptyConnections;
-    const Connections& _connections{_emptyConnections};
-    std::string _buffer;
+    std::mutex _callbackMutex;
+
+    static ConnectionTable _emptyConnections;
+    const ConnectionTable& _connections{_emptyConnections};
 };
 }
 }
@@ -0,0 +1,118 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "topicTable.h"
+
+namespace rockets
+{
+namespace ws
+{
+TopicTable::TopicTable()
+    : _topics{std::make_shared<const Topics>()}
+{
+}
+
+bool TopicTable::subscribe(const std::string& topic, const uintptr_t client,
+                           ConnectionPtr connection)
+{
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    auto it = _topics->find(topic);
+    if (it == _topics->end())
+    {
+        auto topics = std::make_shared<Topics>(*_topics);
+        it = topics->emplace(topic, std::make_shared<Topic>()).first;
+        std::atomic_store(&_topics, std::shared_ptr<const Topics>{topics});
+    }
+
+    auto& entry = *it->second;
+    if (!entry.subscribers.emplace(client, std::move(connection)).second)
+        return false;
+
+    std::atomic_store(&entry.snapshot, Subscribers());
+    _clientTopics[client].insert(topic);
+    return true;
+}
+
+bool TopicTable::unsubscribe(const std::string& topic, const uintptr_t client)
+{
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    if (!_remove(topic, client))
+        return false;
+
+    auto topics = _clientTopics.find(client);
+    topics->second.erase(topic);
+    if (topics->second.empty())
+        _clientTopics.erase(topics);
+    return true;
+}
+
+void TopicTable::removeClient(const uintptr_t client)
+{
+    std::lock_guard<std::mutex> lock{_writeMutex};
+    auto topics = _clientTopics.find(client);
+    if (topics == _clientTopics.end())
+        return;
+
+    for (const auto& topic : topics->second)
+        _remove(topic, client);
+    _clientTopics.erase(topics);
+}
+
+TopicTable::Subscribers TopicTable::getSubscribers(
+    const std::string& topic) const
+{
+    const auto topics = std::atomic_load(&_topics);
+    const auto it = topics->find(topic);
+    if (it == topics->end())
+        return Subscribers();
+
+    auto& entry = *it->second;
+    auto snapshot = std::atomic_load(&entry.snapshot);
+    if (!snapshot)
+    {
+        // first publication since the subscribers changed
+        std::lock_guard<std::mutex> lock{_writeMutex};
+        snapshot = std::atomic_load(&entry.snapshot);
+        if (!snapshot)
+        {
+            snapshot = std::make_shared<const SubscriberMap>(entry.subscribers);
+            std::atomic_store(&entry.snapshot, snapshot);
+        }
+    }
+    return snapshot->empty() ? Subscribers() : snapshot;
+}
+
+bool TopicTable::_remove(const std::string& topic, const uintptr_t client)
+{
+    const auto it = _topics->find(topic);
+    if (it == _topics->end() || it->second->subscribers.erase(client) == 0)
+        return false;
+
+    auto& entry = *it->second;
+    std::atomic_store(&entry.snapshot, Subscribers());
+    if (entry.subscribers.empty())
+    {
+        auto topics = std::make_shared<Topics>(*_topics);
+        topics->erase(topic);
+        std::atomic_store(&_topics, std::shared_ptr<const Topics>{topics});
+    }
+    return true;
+}
+}
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ROCKETS_WS_TOPICTABLE_H
+#define ROCKETS_WS_TOPICTABLE_H
+
+#include <rockets/ws/types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace rockets
+{
+namespace ws
+{
+/**
+ * Table of the topics to which websocket clients are subscribed.
+ *
+ * Publishing gets an immutable snapshot of the subscribers of a topic without
+ * locking. Subscriptions only update the subscribers of the topic in
+ * O(log N), and the next publication copies them once into a new snapshot,
+ * so that N subscriptions cost O(N log N) rather than a copy each. The table
+ * of topics itself is copied when a topic is added or removed.
+ */
+class TopicTable
+{
+public:
+    /** The connections subscribed to a topic, indexed by client ID. */
+    using SubscriberMap = std::map<uintptr_t, ConnectionPtr>;
+    using Subscribers = std::shared_ptr<const SubscriberMap>;
+
+    TopicTable();
+
+    /** @return false if the client was already subscribed. */
+    bool subscribe(const std::string& topic, uintptr_t client,
+                   ConnectionPtr connection);
+
+    /** @return false if the client was not subscribed. */
+    bool unsubscribe(const std::string& topic, uintptr_t client);
+
+    /** Unsubscribe a client from all topics, when it disconnects. */
+    void removeClient(uintptr_t client);
+
+    /** @return the subscribers of a topic, nullptr if it has none. */
+    Subscribers getSubscribers(const std::string& topic) const;
+
+private:
+    struct Topic
+    {
+        SubscriberMap subscribers; // modified under the write mutex
+        Subscribers snapshot;      // atomic, nullptr once outdated
+    };
+    using TopicPtr = std::shared_ptr<Topic>;
+    using Topics = std::unordered_map<std::string, TopicPtr>;
+
+    std::shared_ptr<const Topics> _topics;
+    mutable std::mutex _writeMutex;
+    std::unordered_map<uintptr_t, std::set<std::string>> _clientTopics;
+
+    bool _remove(const std::string& topic, uintptr_t client);
+};
+}
+}
+
+#endif
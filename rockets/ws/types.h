@@ -57,20 +57,25 @@ enum class Recipient
  */
 struct Request
 {
-    Request(const std::string& message_, const uintptr_t clientID_ = 0)
+    Request(const std::string& message_, const uintptr_t clientID_ = 0,
+            const std::string& protocol_ = std::string())
         : message(message_)
         , clientID(clientID_)
+        , protocol(protocol_)
     {
     }
 
-    Request(std::string&& message_, const uintptr_t clientID_ = 0)
+    Request(std::string&& message_, const uintptr_t clientID_ = 0,
+            const std::string& protocol_ = std::string())
         : message(std::move(message_))
         , clientID(clientID_)
+        , protocol(protocol_)
     {
     }
 
     std::string message;
     const uintptr_t clientID;
+    std::string protocol; // websocket protocol of the client connection
 };
 
 /**
@@ -99,6 +104,58 @@ struct Response
     Format format = Format::unspecified; // derive from request format
 };
 
+/**
+ * What to do with a message sent to a connection whose queue of outgoing
+ * messages is full.
+ */
+enum class OverflowPolicy
+{
+    dropOldest,  //!< drop the oldest queued messages to make room
+    dropNewest,  //!< drop the new message
+    coalesce,    //!< replace the queued message with the same key (see
+                 //!< Server::broadcastConflatedText()), if any, otherwise
+                 //!< drop the oldest ones
+    disconnect   //!< drop all messages and close the connection
+};
+
+/** Limits of the queue of outgoing messages of each connection. */
+struct QueueOptions
+{
+    /** Maximum number of queued messages, 0 if unlimited. */
+    size_t maxMessages = 0;
+
+    /**
+     * Maximum size of the queued messages in bytes, 0 if unlimited. A larger
+     * message is still queued if the queue is empty.
+     */
+    size_t maxBytes = 0;
+
+    /** What to do when a message would exceed the limits. */
+    OverflowPolicy policy = OverflowPolicy::dropOldest;
+};
+
+/** Counters of the queue of outgoing messages of a connection. */
+struct QueueStats
+{
+    size_t messages = 0;   //!< currently queued
+    size_t bytes = 0;      //!< currently queued
+    size_t sent = 0;       //!< total written to the connection
+    size_t dropped = 0;    //!< total dropped or replaced by a newer message
+};
+
+/** Options for compressing the messages with permessage-deflate. */
+struct CompressionOptions
+{
+    /** Compression level from 1 (fastest) to 9 (smallest), 0 to disable. */
+    int level = 6;
+
+    /**
+     * Base-two logarithm of the compression window size, from 9 to 15.
+     * Smaller windows use less memory per connection but compress less.
+     */
+    int windowBits = 15;
+};
+
 /** Callback for asynchronously responding to a message. */
 using ResponseCallback = std::function<void(std::string)>;
 
@@ -26,15 +26,21 @@
 
 #include <rockets/helpers.h>
 #include <rockets/http/client.h>
+#include <rockets/http/compressor.h>
 #include <rockets/http/helpers.h>
 #include <rockets/http/request.h>
 #include <rockets/http/response.h>
 #include <rockets/server.h>
 
 #include <libwebsockets.h>
+#if defined(LWS_WITH_LIBUV) || defined(LWS_USE_LIBUV)
+#include <uv.h>
+#endif
 
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <sstream>
 
 #include <boost/mpl/vector.hpp>
 #include <boost/test/unit_test.hpp>
@@ -137,9 +143,11 @@ public:
     }
 
     http::Response check(Server& server, const std::string& uri,
-                         const http::Method method, const std::string& body)
+                         const http::Method method, const std::string& body,
+                         std::map<std::string, std::string> headers = {})
     {
-        auto response = request(server.getURI() + uri, method, body);
+        auto response = request(server.getURI() + uri, method, body,
+                                std::move(headers));
         while (!is_ready(response))
         {
             process(0);
@@ -197,6 +205,15 @@ std::ostream& operator<<(std::ostream& oss, const http::Header& header)
     case Header::RETRY_AFTER:
         oss << "Retry-After";
         break;
+    case Header::ETAG:
+        oss << "ETag";
+        break;
+    case Header::CONTENT_ENCODING:
+        oss << "Content-Encoding";
+        break;
+    case Header::VARY:
+        oss << "Vary";
+        break;
     default:
         oss << "UNDEFINED";
         break;
@@ -429,6 +446,163 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(get_event, F, Fixtures, F)
 
 #if CLIENT_SUPPORTS_REQ_PAYLOAD
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(get_versioned_object_json, F, Fixtures, F)
+{
+    std::atomic<uint64_t> version{1};
+    F::server.handleGET(F::foo.getEndpoint(), F::foo,
+                        [&] { return version.load(); });
+
+    const auto first = F::client.checkGET(F::server, "/test/foo");
+    BOOST_CHECK_EQUAL(first.code, http::Code::OK);
+    BOOST_CHECK_EQUAL(first.body, jsonGet);
+    BOOST_CHECK_EQUAL(first.headers.at(http::Header::CONTENT_TYPE), JSON_TYPE);
+    BOOST_CHECK(!first.headers.at(http::Header::ETAG).empty());
+    BOOST_CHECK(!first.headers.at(http::Header::LAST_MODIFIED).empty());
+    BOOST_CHECK(F::foo.getCalled());
+
+    F::foo.setCalled(false);
+    const auto cached = F::client.checkGET(F::server, "/test/foo");
+    BOOST_CHECK_EQUAL(cached, first);
+    BOOST_CHECK(!F::foo.getCalled());
+
+    ++version;
+    const auto changed = F::client.checkGET(F::server, "/test/foo");
+    BOOST_CHECK_EQUAL(changed.body, jsonGet);
+    BOOST_CHECK_NE(changed.headers.at(http::Header::ETAG),
+                   first.headers.at(http::Header::ETAG));
+    BOOST_CHECK(F::foo.getCalled());
+}
+
+BOOST_AUTO_TEST_CASE(versioned_content_not_modified)
+{
+    size_t serializations = 0;
+    uint64_t version = 1;
+    const http::VersionedContent content{[&] {
+                                             ++serializations;
+                                             return jsonGet;
+                                         },
+                                         [&] { return version; }, JSON_TYPE};
+
+    http::Request request;
+    const auto response = content.respond(request);
+    BOOST_CHECK_EQUAL(response.code, http::Code::OK);
+    const auto etag = response.headers.at(http::Header::ETAG);
+    const auto lastModified = response.headers.at(http::Header::LAST_MODIFIED);
+
+    request.headers["if-none-match"] = etag;
+    BOOST_CHECK_EQUAL(content.respond(request).code, http::Code::NOT_MODIFIED);
+    BOOST_CHECK(content.respond(request).body.empty());
+    request.headers["if-none-match"] = "\"other\", " + etag;
+    BOOST_CHECK_EQUAL(content.respond(request).code, http::Code::NOT_MODIFIED);
+    BOOST_CHECK_EQUAL(serializations, 1);
+
+    request.headers.clear();
+    request.headers["if-modified-since"] = lastModified;
+    BOOST_CHECK_EQUAL(content.respond(request).code, http::Code::NOT_MODIFIED);
+
+    ++version;
+    request.headers.clear();
+    request.headers["if-none-match"] = etag;
+    BOOST_CHECK_EQUAL(content.respond(request).code, http::Code::OK);
+    BOOST_CHECK_EQUAL(serializations, 2);
+}
+
+BOOST_AUTO_TEST_CASE(compress_response_for_accepted_encoding)
+{
+    if (!http::Compressor::isSupported())
+        return;
+
+    http::CompressionOptions options;
+    options.minSize = 64;
+    const http::Compressor compressor{options};
+
+    http::Request request;
+    BOOST_CHECK_EQUAL(compressor.negotiate(request), "");
+    request.headers["accept-encoding"] = "deflate, gzip;q=0";
+    BOOST_CHECK_EQUAL(compressor.negotiate(request), "deflate");
+    request.headers["accept-encoding"] = "gzip, deflate, br";
+    BOOST_CHECK_EQUAL(compressor.negotiate(request), "gzip");
+    request.headers["accept-encoding"] = "identity";
+    BOOST_CHECK_EQUAL(compressor.negotiate(request), "");
+
+    const std::string body(1000, 'x');
+    http::Response small{http::Code::OK, "too small to compress"};
+    compressor.compress(small, "gzip", "/small");
+    BOOST_CHECK_EQUAL(small.body, "too small to compress");
+    BOOST_CHECK_EQUAL(small.headers.count(http::Header::CONTENT_ENCODING), 0);
+
+    http::Response identity{http::Code::OK, body};
+    compressor.compress(identity, "", "/identity");
+    BOOST_CHECK_EQUAL(identity.body, body);
+    BOOST_CHECK_EQUAL(identity.headers.at(http::Header::VARY),
+                      "Accept-Encoding");
+
+    const http::Response::Headers headers{{http::Header::ETAG, "\"1\""}};
+    http::Response gzip{http::Code::OK, body, headers};
+    compressor.compress(gzip, "gzip", "/gzip");
+    BOOST_CHECK_EQUAL(gzip.headers.at(http::Header::CONTENT_ENCODING), "gzip");
+    BOOST_CHECK_EQUAL(gzip.headers.at(http::Header::ETAG), "W/\"1\"");
+    BOOST_REQUIRE_LT(gzip.body.size(), body.size());
+    BOOST_CHECK_EQUAL(gzip.body.substr(0, 2), "\x1f\x8b"); // gzip magic
+
+    // the compressed body is cached by path and ETag
+    const auto compressed = gzip.body;
+    http::Response cached{http::Code::OK, "modified " + body, headers};
+    compressor.compress(cached, "gzip", "/gzip");
+    BOOST_CHECK_EQUAL(cached.body, compressed);
+
+    // the same ETag of another resource is another content
+    const std::string otherBody(1000, 'y');
+    http::Response other{http::Code::OK, otherBody, headers};
+    compressor.compress(other, "gzip", "/other");
+    BOOST_REQUIRE_LT(other.body.size(), otherBody.size());
+    BOOST_CHECK_NE(other.body, compressed);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(get_compressed_versioned_content, F, Fixtures,
+                                 F)
+{
+    http::CompressionOptions options;
+    options.minSize = 64;
+    if (!F::server.setCompression(options))
+        return; // Rockets built without compression support
+
+    const std::string body(1000, 'x');
+    const http::VersionedContent content{[&] { return body; },
+                                         [] { return uint64_t{1}; }, JSON_TYPE};
+    F::server.handle(http::Method::GET, "big",
+                     [&](const http::Request& request) {
+                         return content.respond(request);
+                     });
+
+    const std::map<std::string, std::string> gzip{{"Accept-Encoding", "gzip"}};
+    const auto compressed =
+        F::client.check(F::server, "/big", http::Method::GET, "", gzip);
+    BOOST_CHECK_EQUAL(compressed.code, http::Code::OK);
+    BOOST_CHECK_EQUAL(compressed.headers.at(http::Header::CONTENT_ENCODING),
+                      "gzip");
+    BOOST_CHECK_EQUAL(compressed.headers.at(http::Header::VARY),
+                      "Accept-Encoding");
+    BOOST_CHECK_LT(compressed.body.size(), body.size());
+    const auto etag = compressed.headers.at(http::Header::ETAG);
+    BOOST_CHECK_EQUAL(etag.substr(0, 2), "W/");
+
+    // the weak ETag still validates the cached content
+    auto conditional = gzip;
+    conditional["If-None-Match"] = etag;
+    const auto notModified =
+        F::client.check(F::server, "/big", http::Method::GET, "", conditional);
+    BOOST_CHECK_EQUAL(notModified.code, http::Code::NOT_MODIFIED);
+    BOOST_CHECK(notModified.body.empty());
+
+    const auto uncompressed = F::client.checkGET(F::server, "/big");
+    BOOST_CHECK_EQUAL(uncompressed.body, body);
+    BOOST_CHECK_EQUAL(
+        uncompressed.headers.count(http::Header::CONTENT_ENCODING), 0);
+    BOOST_CHECK_EQUAL(uncompressed.headers.at(http::Header::VARY),
+                      "Accept-Encoding");
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(put_object_json, F, Fixtures, F)
 {
     F::server.handlePUT(F::foo.getEndpoint(), F::foo);
@@ -641,6 +815,52 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(handle_path, F, Fixtures, F)
     BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/api/size"), response200);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(handle_path_parameters, F, Fixtures, F)
+{
+    const auto paramsFunc = [](const http::Request& request) {
+        std::string body;
+        for (const auto& kv : request.pathParams)
+            body.append(kv.first + "=" + kv.second + ";");
+        return http::Response{http::Code::OK, body + request.path};
+    };
+    const auto get = http::Method::GET;
+    F::server.handle(get, "volumes/{id}", paramsFunc);
+    F::server.handle(get, "volumes/{id}/slices/{z:int}", paramsFunc);
+    F::server.handle(get, "volumes/{id}/files/", paramsFunc);
+    F::server.handle(get, "volumes/all", echoFunc);
+    F::server.handle(http::Method::PUT, "volumes/{id}/slices/{z:int}",
+                     paramsFunc);
+
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/v1"),
+                      http::Response(http::Code::OK, "id=v1;"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/all"),
+                      response200);
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/all/slices/3"),
+                      http::Response(http::Code::OK, "id=all;z=3;"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/v1/slices/-2"),
+                      http::Response(http::Code::OK, "id=v1;z=-2;"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/v1/slices/a"),
+                      error404);
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/v1/files/a/b"),
+                      http::Response(http::Code::OK, "id=v1;a/b"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes"), error404);
+
+    const http::Response error405{http::Code::NOT_SUPPORTED,
+                                  "",
+                                  {{http::Header::ALLOW, "GET, PUT"}}};
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/volumes/v2/slices/4",
+                                          ""),
+                      error405);
+
+    BOOST_CHECK_THROW(F::server.handle(get, "volumes/{id:float}", echoFunc),
+                      std::invalid_argument);
+    BOOST_CHECK_THROW(F::server.handle(get, "volumes/{}", echoFunc),
+                      std::invalid_argument);
+    BOOST_CHECK(!F::server.handle(get, "volumes/{id}", echoFunc));
+    BOOST_CHECK(F::server.remove("volumes/{id}"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/volumes/v1"), error404);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(handle_headers, F, Fixtures, F)
 {
     const std::string allow = "GET, POST, PUT, PATCH, DELETE";
@@ -819,5 +1039,371 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(multiple_event_name_for_same_object, F,
                       error405put);
 }
 
+BOOST_AUTO_TEST_CASE(slow_handler_does_not_block_other_requests)
+{
+    Server server{1u};
+    server.setHandlerThreadCount(2);
+    BOOST_CHECK_EQUAL(server.getHandlerThreadCount(), 2);
+
+    std::atomic_bool slowRequestDone{false};
+    server.handle(http::Method::GET, "slow", [&](const http::Request&) {
+        while (!slowRequestDone)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return http::make_ready_response(http::Code::OK, "slow");
+    });
+    server.handle(http::Method::GET, "fast", [](const http::Request&) {
+        return http::make_ready_response(http::Code::OK, "fast");
+    });
+
+    MockClient client;
+    auto slowResponse = client.request(server.getURI() + "/slow");
+    BOOST_CHECK_EQUAL(client.checkGET(server, "/fast"),
+                      http::Response(http::Code::OK, "fast"));
+    BOOST_CHECK(!is_ready(slowResponse));
+
+    slowRequestDone = true;
+    while (!is_ready(slowResponse))
+        client.process(0);
+    BOOST_CHECK_EQUAL(slowResponse.get(),
+                      http::Response(http::Code::OK, "slow"));
+}
+
+BOOST_AUTO_TEST_CASE(register_endpoints_while_serving_requests)
+{
+    Server server{4u};
+    server.handle(http::Method::GET, "stable/{id}", echoFunc);
+
+    std::atomic_bool running{true};
+    std::atomic<size_t> errors{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&server, &running, &errors, i] {
+            MockClient client;
+            const auto id = std::to_string(i);
+            const auto dynamic = "/dynamic" + id + "/" + id;
+            while (running)
+            {
+                auto code = client.checkGET(server, "/stable/" + id).code;
+                if (code != http::Code::OK)
+                    ++errors;
+                code = client.checkGET(server, dynamic).code;
+                if (code != http::Code::OK && code != http::Code::NOT_FOUND)
+                    ++errors;
+            }
+        });
+    }
+
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        const auto endpoint = "dynamic" + std::to_string(i % 4) + "/{id:int}";
+        BOOST_CHECK(server.handle(http::Method::GET, endpoint, echoFunc));
+        BOOST_CHECK(server.remove(endpoint));
+    }
+    running = false;
+    for (auto& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(errors, 0);
+}
+
+BOOST_AUTO_TEST_CASE(handler_executor_rejects_requests_when_queue_is_full)
+{
+    Server server{1u};
+    server.setHandlerThreadCount(1, 0);
+    server.handle(http::Method::GET, "test", echoFunc);
+
+    MockClient client;
+    BOOST_CHECK_EQUAL(client.checkGET(server, "/test"),
+                      http::Response(http::Code::SERVICE_UNAVAILABLE));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(handle_ready_and_deferred_replies, F,
+                                 Fixtures, F)
+{
+    F::server.handle(http::Method::GET, "ready", [](const http::Request&) {
+        return http::Response{http::Code::OK, "ready"};
+    });
+    F::server.handle(http::Method::GET, "deferred/",
+                     [](const http::Request& request) -> http::Reply {
+                         if (request.path.empty())
+                             return http::Response{http::Code::NO_CONTENT};
+                         return std::async(std::launch::async, [request] {
+                             return http::Response{http::Code::OK,
+                                                   request.path};
+                         });
+                     });
+
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/ready"),
+                      http::Response(http::Code::OK, "ready"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/deferred/"),
+                      response204);
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/deferred/path"),
+                      http::Response(http::Code::OK, "path"));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(respond_asynchronously_from_other_thread, F,
+                                 Fixtures, F)
+{
+    std::vector<std::thread> threads;
+    F::server.handleAsync(http::Method::GET, "async/",
+                          [&](const http::Request& request,
+                              http::Responder responder) {
+                              threads.emplace_back([request, responder] {
+                                  std::this_thread::sleep_for(
+                                      std::chrono::milliseconds(10));
+                                  responder.respond({http::Code::OK,
+                                                     request.path});
+                              });
+                          });
+    F::server.handleAsync(http::Method::GET, "dropped",
+                          [](const http::Request&, http::Responder) {});
+
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/async/path"),
+                      http::Response(http::Code::OK, "path"));
+    BOOST_CHECK_EQUAL(F::client.checkGET(F::server, "/dropped"),
+                      http::Response(http::Code::INTERNAL_SERVER_ERROR));
+    for (auto& thread : threads)
+        thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(respond_after_server_destruction)
+{
+    auto server = std::make_unique<Server>(1u);
+    server->setHandlerThreadCount(1);
+    std::promise<http::Responder> kept;
+    server->handleAsync(http::Method::GET, "kept",
+                        [&kept](const http::Request&,
+                                http::Responder responder) {
+                            kept.set_value(responder);
+                        });
+
+    MockClient client;
+    auto response = client.request(server->getURI() + "/kept");
+    auto responder = kept.get_future();
+    while (responder.wait_for(std::chrono::milliseconds(1)) !=
+           std::future_status::ready)
+    {
+        client.process(0);
+    }
+
+    // the application may keep the responder beyond the server's lifetime
+    auto keptResponder = responder.get();
+    server.reset();
+    BOOST_CHECK(keptResponder.respond({http::Code::OK}));
+}
+
+#if defined(LWS_WITH_LIBUV) || defined(LWS_USE_LIBUV)
+BOOST_AUTO_TEST_CASE(respond_asynchronously_on_uv_loop)
+{
+    uv_loop_t loop;
+    uv_loop_init(&loop);
+    // the server requires a running loop, i.e. one with an active handle
+    uv_timer_t timer;
+    uv_timer_init(&loop, &timer);
+    uv_timer_start(&timer, [](uv_timer_t*) {}, 0, 10);
+
+    std::thread responseThread;
+    {
+        Server server{&loop, "", ""};
+        server.handleAsync(http::Method::GET, "async",
+                           [&](const http::Request&,
+                               http::Responder responder) {
+                               // the loop must be woken up for the response
+                               responseThread = std::thread([responder] {
+                                   responder.respond({http::Code::OK});
+                               });
+                           });
+
+        MockClient client;
+        auto response = client.request(server.getURI() + "/async");
+        int maxServiceLoops = 200;
+        while (!is_ready(response) && --maxServiceLoops)
+        {
+            client.process(10);
+            uv_run(&loop, UV_RUN_NOWAIT);
+        }
+        BOOST_REQUIRE(is_ready(response));
+        BOOST_CHECK_EQUAL(response.get().code, http::Code::OK);
+        if (responseThread.joinable())
+            responseThread.join();
+    }
+
+    uv_close(reinterpret_cast<uv_handle_t*>(&timer), nullptr);
+    uv_run(&loop, UV_RUN_DEFAULT);
+    uv_loop_close(&loop);
+}
+#endif
+
+http::Response::BodyProducer makeProducer(const std::string& body)
+{
+    auto offset = std::make_shared<size_t>(0);
+    return [body, offset](char* data, const size_t size) {
+        const auto n = std::min(size, body.size() - *offset);
+        std::copy_n(body.data() + *offset, n, data);
+        *offset += n;
+        return n;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(stream_response_with_known_size, F, Fixtures,
+                                 F)
+{
+    const std::string body(1024 * 1024 + 3, 'a');
+    F::server.handle(http::Method::GET, "stream", [&](const http::Request&) {
+        return http::make_ready_response(
+            http::Response{http::Code::OK, makeProducer(body), body.size()});
+    });
+
+    const auto response = F::client.checkGET(F::server, "/stream");
+    BOOST_CHECK_EQUAL(response.code, http::Code::OK);
+    BOOST_CHECK_EQUAL(response.body.size(), body.size());
+    BOOST_CHECK(response.body == body);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(stream_response_with_chunked_encoding, F,
+                                 Fixtures, F)
+{
+    const std::string body(300 * 1024 + 7, 'b');
+    F::server.handle(http::Method::GET, "stream", [&](const http::Request&) {
+        return http::make_ready_response(
+            http::Response{http::Code::OK, makeProducer(body), 0});
+    });
+
+    const auto response = F::client.checkGET(F::server, "/stream");
+    BOOST_CHECK_EQUAL(response.code, http::Code::OK);
+    BOOST_CHECK_EQUAL(response.body.size(), body.size());
+    BOOST_CHECK(response.body == body);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(reject_payload_larger_than_max_size, F,
+                                 Fixtures, F)
+{
+    http::BodyOptions options;
+    options.maxSize = 16;
+    F::server.handle(http::Method::POST, "limited", echoFunc, options);
+
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/limited", "small"),
+                      http::Response(http::Code::OK, "small"));
+    BOOST_CHECK_EQUAL(
+        F::client.checkPOST(F::server, "/limited", std::string(100, 'a')),
+        http::Response(http::Code::PAYLOAD_TOO_LARGE));
+}
+
+class CountingSink : public http::BodySink
+{
+public:
+    void onData(const char* data, const size_t size) final
+    {
+        for (size_t i = 0; i < size; ++i)
+            if (data[i] != 'a')
+                return;
+        _size += size;
+    }
+    std::future<http::Response> onComplete(const http::Request& request) final
+    {
+        BOOST_CHECK(request.body.empty());
+        return http::make_ready_response(http::Code::OK,
+                                         std::to_string(_size));
+    }
+
+private:
+    size_t _size = 0;
+};
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(stream_request_payload_to_sink, F, Fixtures, F)
+{
+    F::server.handleStream(http::Method::POST, "upload",
+                           [](const http::Request&) {
+                               return std::unique_ptr<http::BodySink>(
+                                   new CountingSink);
+                           });
+
+    const std::string body(1024 * 1024, 'a');
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/upload", body),
+                      http::Response(http::Code::OK, std::to_string(
+                                                         body.size())));
+}
+
+class BlockingFilter : public http::Filter
+{
+public:
+    bool filter(const http::Request& request) const final
+    {
+        return request.path == "/upload";
+    }
+    http::Response getResponse(const http::Request&) const final
+    {
+        return http::Response{http::Code::FORBIDDEN};
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(filter_request_before_payload, F, Fixtures, F)
+{
+    BlockingFilter filter;
+    F::server.setHttpFilter(&filter);
+    bool sinkCreated = false;
+    F::server.handleStream(http::Method::POST, "upload",
+                           [&sinkCreated](const http::Request&) {
+                               sinkCreated = true;
+                               return std::unique_ptr<http::BodySink>(
+                                   new CountingSink);
+                           });
+
+    const std::string body(1024 * 1024, 'a');
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/upload", body),
+                      http::Response(http::Code::FORBIDDEN));
+    BOOST_CHECK(!sinkCreated);
+    F::server.setHttpFilter(nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(stream_without_sink_is_an_error, F, Fixtures,
+                                 F)
+{
+    F::server.handleStream(http::Method::POST, "nosink",
+                           [](const http::Request&) {
+                               return std::unique_ptr<http::BodySink>();
+                           });
+    F::server.handleStream(
+        http::Method::POST, "throwing",
+        [](const http::Request&) -> std::unique_ptr<http::BodySink> {
+            throw std::runtime_error("no sink");
+        });
+
+    const http::Response error500{http::Code::INTERNAL_SERVER_ERROR};
+    for (const auto& body : {std::string(), std::string("payload")})
+    {
+        BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/nosink", body),
+                          error500);
+        BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/throwing", body),
+                          error500);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(spill_large_payload_to_file, F, Fixtures, F)
+{
+    http::BodyOptions options;
+    options.spillSize = 1024;
+    F::server.handle(http::Method::POST, "upload",
+                     [](const http::Request& request) {
+                         if (request.bodyFile.empty())
+                             return echoFunc(request);
+
+                         std::ifstream file(request.bodyFile);
+                         std::stringstream content;
+                         content << file.rdbuf();
+                         return http::make_ready_response(http::Code::OK,
+                                                          content.str());
+                     },
+                     options);
+
+    const std::string small(1024, 'a');
+    const std::string large(100 * 1024, 'b');
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/upload", small),
+                      http::Response(http::Code::OK, small));
+    BOOST_CHECK_EQUAL(F::client.checkPOST(F::server, "/upload", large),
+                      http::Response(http::Code::OK, large));
+}
+
 #endif // CLIENT_SUPPORTS_REQ_PAYLOAD
 #endif // CLIENT_SUPPORTS_REP_PAYLOAD
@@ -22,6 +22,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "rockets/json.hpp"
+#include "rockets/jsonrpc/jsonTypes.h"
 #include "rockets/jsonrpc/receiver.h"
 
 // Validation examples based on: http://www.jsonrpc.org/specification
@@ -64,172 +65,49 @@ const std::string invalidJsonRpcVersionRequest{
     R"({"jsonrpc": "3.5", "method": "subtract", "params": [42, 23], "id": 3})"};
 
 const std::string substractResult{
-    R"({
-    "id": 3,
-    "jsonrpc": "2.0",
-    "result": 19
-})"};
+    R"({"id":3,"jsonrpc":"2.0","result":19})"};
 
 const std::string substractResultStringId{
-    R"({
-    "id": "myId123",
-    "jsonrpc": "2.0",
-    "result": 19
-})"};
+    R"({"id":"myId123","jsonrpc":"2.0","result":19})"};
 
 const std::string connectStandardReply{
-    R"({
-    "id": 3,
-    "jsonrpc": "2.0",
-    "result": "OK"
-})"};
+    R"({"id":3,"jsonrpc":"2.0","result":"OK"})"};
 
 const std::string substractBatchResult{
-    R"([
-    {
-        "id": 1,
-        "jsonrpc": "2.0",
-        "result": 19
-    },
-    {
-        "id": 3,
-        "jsonrpc": "2.0",
-        "result": 19
-    }
-])"};
+    R"([{"id":1,"jsonrpc":"2.0","result":19},{"id":3,"jsonrpc":"2.0","result":19}])"};
 
 const std::string nonExistantMethodResult{
-    R"({
-    "error": {
-        "code": -32601,
-        "message": "Method not found"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32601,"message":"Method not found"},"id":3,"jsonrpc":"2.0"})"};
 
 const std::string invalidJsonResult{
-    R"({
-    "error": {
-        "code": -32700,
-        "data": "[json.exception.parse_error.101] parse error at 1: syntax error - invalid literal; last read: 'Z'",
-        "message": "Parse error"
-    },
-    "id": null,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32700,"data":"[json.exception.parse_error.101] parse error at 1: syntax error - invalid literal; last read: 'Z'","message":"Parse error"},"id":null,"jsonrpc":"2.0"})"};
 
 const std::string invalidJsonArrayResult{
-    R"({
-    "error": {
-        "code": -32700,
-        "data": "[json.exception.parse_error.101] parse error at 10: syntax error - unexpected ':'; expected ']'",
-        "message": "Parse error"
-    },
-    "id": null,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32700,"data":"[json.exception.parse_error.101] parse error at 10: syntax error - unexpected ':'; expected ']'","message":"Parse error"},"id":null,"jsonrpc":"2.0"})"};
 
 const std::string internalErrorInvalidJson{
-    R"({
-    "error": {
-        "code": -32603,
-        "data": "Server response is not a valid json string",
-        "message": "Internal error"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32603,"data":"Server response is not a valid json string","message":"Internal error"},"id":3,"jsonrpc":"2.0"})"};
 
 const std::string invalidRequestResult{
-    R"({
-    "error": {
-        "code": -32600,
-        "message": "Invalid Request"
-    },
-    "id": 6,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32600,"message":"Invalid Request"},"id":6,"jsonrpc":"2.0"})"};
 
 const std::string invalidJsonRpcVersionResult{
-    R"({
-    "error": {
-        "code": -32600,
-        "message": "Invalid Request"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32600,"message":"Invalid Request"},"id":3,"jsonrpc":"2.0"})"};
 
 const std::string invalidParams{
-    R"({
-    "error": {
-        "code": -32602,
-        "message": "Invalid params"
-    },
-    "id": null,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32602,"message":"Invalid params"},"id":null,"jsonrpc":"2.0"})"};
 
 const std::string invalidParamsResult{
-    R"({
-    "error": {
-        "code": -32602,
-        "message": "Invalid params"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32602,"message":"Invalid params"},"id":3,"jsonrpc":"2.0"})"};
 
 const std::string customSubstrationErrorResult{
-    R"({
-    "error": {
-        "code": -1234,
-        "message": "No substractions today"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-1234,"message":"No substractions today"},"id":3,"jsonrpc":"2.0"})"};
 
 const std::string invalidBatch1RequestResult{
-    R"([
-    {
-        "error": {
-            "code": -32600,
-            "message": "Invalid Request"
-        },
-        "id": null,
-        "jsonrpc": "2.0"
-    }
-])"};
+    R"([{"error":{"code":-32600,"message":"Invalid Request"},"id":null,"jsonrpc":"2.0"}])"};
 
 const std::string invalidBatch3RequestResult{
-    R"([
-    {
-        "error": {
-            "code": -32600,
-            "message": "Invalid Request"
-        },
-        "id": null,
-        "jsonrpc": "2.0"
-    },
-    {
-        "error": {
-            "code": -32600,
-            "message": "Invalid Request"
-        },
-        "id": null,
-        "jsonrpc": "2.0"
-    },
-    {
-        "error": {
-            "code": -32600,
-            "message": "Invalid Request"
-        },
-        "id": null,
-        "jsonrpc": "2.0"
-    }
-])"};
+    R"([{"error":{"code":-32600,"message":"Invalid Request"},"id":null,"jsonrpc":"2.0"},{"error":{"code":-32600,"message":"Invalid Request"},"id":null,"jsonrpc":"2.0"},{"error":{"code":-32600,"message":"Invalid Request"},"id":null,"jsonrpc":"2.0"}])"};
 }
 
 using namespace rockets;
@@ -295,6 +173,14 @@ BOOST_FIXTURE_TEST_CASE(process_obj, Fixture)
     BOOST_CHECK_EQUAL(jsonRpc.process(substractObject), substractResult);
 }
 
+BOOST_FIXTURE_TEST_CASE(process_obj_pretty_print, Fixture)
+{
+    jsonRpc.bind("subtract", std::bind(&substractObj, std::placeholders::_1));
+    jsonRpc.setPrettyPrint(true);
+    BOOST_CHECK_EQUAL(jsonRpc.process(substractObject),
+                      rockets_nlohmann::json::parse(substractResult).dump(4));
+}
+
 BOOST_FIXTURE_TEST_CASE(process_arr, Fixture)
 {
     jsonRpc.bind("subtract", std::bind(&substractArr, std::placeholders::_1));
@@ -360,6 +246,20 @@ BOOST_FIXTURE_TEST_CASE(bind_with_params_and_retval_error, Fixture)
                       customSubstrationErrorResult);
 }
 
+BOOST_FIXTURE_TEST_CASE(bind_json, Fixture)
+{
+    jsonRpc.bindJson("subtract", [](const jsonrpc::JsonRequest& request) {
+        const auto& params = request.params;
+        if (!params.count("minuend") || !params.count("subtrahend"))
+            throw jsonrpc::response_error("No substractions today", -1234);
+        return rockets_nlohmann::json(params["minuend"].get<int>() -
+                                      params["subtrahend"].get<int>());
+    });
+    BOOST_CHECK_EQUAL(jsonRpc.process(substractObject), substractResult);
+    BOOST_CHECK_EQUAL(jsonRpc.process(substractArray),
+                      customSubstrationErrorResult);
+}
+
 BOOST_FIXTURE_TEST_CASE(connect_with_params, Fixture)
 {
     int called = 0;
@@ -23,7 +23,10 @@
 
 #include "rockets/json.hpp"
 #include "rockets/jsonrpc/asyncReceiver.h"
+#include "rockets/jsonrpc/jsonTypes.h"
 
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 // Validation examples based on: http://www.jsonrpc.org/specification
@@ -34,24 +37,13 @@ const std::string substractArray{
     R"({"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": 3})"};
 
 const std::string substractResult{
-    R"({
-    "id": 3,
-    "jsonrpc": "2.0",
-    "result": 19
-})"};
+    R"({"id":3,"jsonrpc":"2.0","result":19})"};
 
 const std::string substractObject{
     R"({"jsonrpc": "2.0", "method": "subtract", "params": {"subtrahend": 23, "minuend": 42}, "id": 3})"};
 
 const std::string invalidParamsResult{
-    R"({
-    "error": {
-        "code": -32602,
-        "message": "Invalid params"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-32602,"message":"Invalid params"},"id":3,"jsonrpc":"2.0"})"};
 }
 
 using namespace rockets;
@@ -140,6 +132,160 @@ BOOST_FIXTURE_TEST_CASE(bind_async_with_params, Fixture)
                       invalidParamsResult);
 }
 
+BOOST_FIXTURE_TEST_CASE(bind_async_json, Fixture)
+{
+    jsonRpcAsync.bindAsyncJson(
+        "subtract", [](const jsonrpc::JsonRequest& request,
+                       jsonrpc::AsyncJsonResponse callback) {
+            const auto& params = request.params;
+            if (!params.count("minuend") || !params.count("subtrahend"))
+            {
+                callback(jsonrpc::Response::invalidParams().error);
+                return;
+            }
+            const auto value = params["minuend"].get<int>() -
+                               params["subtrahend"].get<int>();
+            std::thread([callback, value] {
+                callback(rockets_nlohmann::json(value));
+            }).detach();
+        });
+    BOOST_CHECK_EQUAL(jsonRpcAsync.processAsync(substractObject).get(),
+                      substractResult);
+    BOOST_CHECK_EQUAL(jsonRpcAsync.processAsync(substractArray).get(),
+                      invalidParamsResult);
+}
+
+BOOST_FIXTURE_TEST_CASE(rebind_replaces_method, Fixture)
+{
+    using namespace std::placeholders;
+    jsonRpcAsync.bindAsync("subtract", [](const jsonrpc::Request&,
+                                          jsonrpc::AsyncResponse callback) {
+        callback(jsonrpc::Response{"0"});
+    });
+    jsonRpcAsync.bind("subtract", std::bind(&substractArr, _1));
+    BOOST_CHECK_EQUAL(jsonRpcAsync.processAsync(substractArray).get(),
+                      substractResult);
+}
+
+void checkMixedBatch(jsonrpc::AsyncReceiver& receiver, const int size)
+{
+    using json = rockets_nlohmann::json;
+
+    json batch;
+    for (int i = 0; i < size; ++i)
+    {
+        batch.push_back({{"jsonrpc", "2.0"},
+                         {"method", i % 2 ? "subtractAsync" : "subtract"},
+                         {"params", {i, 1}},
+                         {"id", i}});
+    }
+    const auto responses =
+        json::parse(receiver.processAsync(batch.dump()).get());
+    BOOST_REQUIRE_EQUAL(responses.size(), size);
+    for (int i = 0; i < size; ++i)
+    {
+        BOOST_CHECK_EQUAL(responses[i]["id"].get<int>(), i);
+        BOOST_CHECK_EQUAL(responses[i]["result"].get<int>(), i - 1);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(process_mixed_batch, Fixture)
+{
+    using namespace std::placeholders;
+    jsonRpcAsync.bind("subtract", std::bind(&substractArr, _1));
+    jsonRpcAsync.bindAsync("subtractAsync",
+                           std::bind(&substractArrAsync, _1, _2));
+    checkMixedBatch(jsonRpcAsync, 1000);
+
+    jsonRpcAsync.setBatchThreadCount(4);
+    checkMixedBatch(jsonRpcAsync, 1000);
+}
+
+BOOST_FIXTURE_TEST_CASE(process_batch_does_not_block, Fixture)
+{
+    std::vector<jsonrpc::AsyncResponse> pending;
+    jsonRpcAsync.bindAsync("later",
+                           [&pending](const jsonrpc::Request&,
+                                      jsonrpc::AsyncResponse callback) {
+                               pending.push_back(callback);
+                           });
+    auto response = jsonRpcAsync.processAsync(std::string{
+        R"([{"jsonrpc": "2.0", "method": "later", "id": 1},
+            {"jsonrpc": "2.0", "method": "later", "id": 2}])"});
+
+    // the async responses are only given after the batch was dispatched
+    BOOST_REQUIRE_EQUAL(pending.size(), 2);
+    BOOST_CHECK(response.wait_for(std::chrono::seconds(0)) !=
+                std::future_status::ready);
+    pending[1](jsonrpc::Response{"2"});
+    pending[0](jsonrpc::Response{"1"});
+    BOOST_CHECK_EQUAL(response.get(),
+                      R"([{"id":1,"jsonrpc":"2.0","result":1},)"
+                      R"({"id":2,"jsonrpc":"2.0","result":2}])");
+}
+
+BOOST_FIXTURE_TEST_CASE(throwing_method_in_batch_is_an_internal_error,
+                        Fixture)
+{
+    jsonRpcAsync.bind("throw", [](const jsonrpc::Request&) -> jsonrpc::Response {
+        throw std::runtime_error("failed");
+    });
+    const std::string batch{
+        R"([{"jsonrpc": "2.0", "method": "throw", "id": 1},
+            {"jsonrpc": "2.0", "method": "throw"}])"};
+    const std::string result{
+        R"([{"error":{"code":-32603,"message":"Internal error"},)"
+        R"("id":1,"jsonrpc":"2.0"}])"};
+
+    jsonrpc::Receiver& receiver = jsonRpcAsync;
+    BOOST_CHECK_EQUAL(receiver.process(batch), result);
+    receiver.setBatchThreadCount(2);
+    BOOST_CHECK_EQUAL(receiver.process(batch), result);
+}
+
+BOOST_FIXTURE_TEST_CASE(batch_threads_call_methods_concurrently, Fixture)
+{
+    // each call waits for the other one, so both must run at the same time
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t running = 0;
+    jsonRpcAsync.bind("meet", [&](const jsonrpc::Request&) {
+        std::unique_lock<std::mutex> lock{mutex};
+        ++running;
+        condition.notify_all();
+        const bool met = condition.wait_for(lock, std::chrono::seconds(5),
+                                            [&] { return running == 2; });
+        return jsonrpc::Response{met ? "true" : "false"};
+    });
+    const std::string batch{
+        R"([{"jsonrpc": "2.0", "method": "meet", "id": 1},
+            {"jsonrpc": "2.0", "method": "meet", "id": 2}])"};
+
+    jsonrpc::Receiver& receiver = jsonRpcAsync;
+    receiver.setBatchThreadCount(2);
+    BOOST_CHECK_EQUAL(receiver.process(batch),
+                      R"([{"id":1,"jsonrpc":"2.0","result":true},)"
+                      R"({"id":2,"jsonrpc":"2.0","result":true}])");
+}
+
+BOOST_FIXTURE_TEST_CASE(process_does_not_wait_for_delayed_response, Fixture)
+{
+    jsonrpc::AsyncResponse pending;
+    jsonRpcAsync.bindAsync("later",
+                           [&pending](const jsonrpc::Request&,
+                                      jsonrpc::AsyncResponse callback) {
+                               pending = callback;
+                           });
+    jsonrpc::Receiver& receiver = jsonRpcAsync;
+    receiver.setBatchThreadCount(2);
+    BOOST_CHECK(receiver
+                    .process(std::string{
+                        R"({"jsonrpc": "2.0", "method": "later", "id": 1})"})
+                    .empty());
+    BOOST_REQUIRE(pending);
+    pending(jsonrpc::Response{"1"});
+}
+
 BOOST_FIXTURE_TEST_CASE(reserved_method_names, Fixture)
 {
     using namespace std::placeholders;
@@ -23,6 +23,7 @@
 
 #include "rockets/json.hpp"
 #include "rockets/jsonrpc/cancellableReceiver.h"
+#include "rockets/jsonrpc/jsonTypes.h"
 
 #include <iostream>
 #include <thread>
@@ -32,32 +33,16 @@ const std::string action{
     R"({"jsonrpc": "2.0", "method": "action", "id": 4})"};
 
 const std::string actionResponse{
-    R"({
-    "id": 4,
-    "jsonrpc": "2.0",
-    "result": 42
-})"};
+    R"({"id":4,"jsonrpc":"2.0","result":42})"};
 
 const std::string progressMessage{
-    R"({
-    "jsonrpc": "2.0",
-    "method": "progress",
-    "params": {
-        "amount": 1.0,
-        "id": 4,
-        "operation": "update"
-    }
-})"};
+    R"({"jsonrpc":"2.0","method":"progress","params":{"amount":1.0,"id":4,"operation":"update"}})"};
 
 const std::string substractArray{
     R"({"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": 3})"};
 
 const std::string substractResult{
-    R"({
-    "id": 3,
-    "jsonrpc": "2.0",
-    "result": 19
-})"};
+    R"({"id":3,"jsonrpc":"2.0","result":19})"};
 
 const std::string cancelSubstractArray{
     R"({"jsonrpc": "2.0", "method": "cancel", "params": { "id": 3 }})"};
@@ -69,14 +54,7 @@ const std::string invalidCancelNoID{
     R"({"jsonrpc": "2.0", "method": "cancel", "params": { "foo": 3 }})"};
 
 const std::string cancelledRequestResult{
-    R"({
-    "error": {
-        "code": -31002,
-        "message": "Request aborted"
-    },
-    "id": 3,
-    "jsonrpc": "2.0"
-})"};
+    R"({"error":{"code":-31002,"message":"Request aborted"},"id":3,"jsonrpc":"2.0"})"};
 }
 
 using namespace rockets;
@@ -238,3 +216,27 @@ BOOST_FIXTURE_TEST_CASE(process_arr_async_progress, Fixture)
     BOOST_CHECK_EQUAL(jsonRpc.processAsync(action).get(), actionResponse);
     BOOST_CHECK_EQUAL(message, progressMessage);
 }
+
+BOOST_FIXTURE_TEST_CASE(bind_async_json_cancel_and_progress, Fixture)
+{
+    jsonRpc.bindAsyncJson(
+        "action", [](const jsonrpc::JsonRequest&,
+                     jsonrpc::AsyncJsonResponse callback,
+                     jsonrpc::ProgressUpdateCallback progress) {
+            progress("update", 1.f);
+            callback(rockets_nlohmann::json(42));
+            return jsonrpc::CancelRequestCallback{};
+        });
+    BOOST_CHECK_EQUAL(jsonRpc.processAsync(action).get(), actionResponse);
+    BOOST_CHECK_EQUAL(message, progressMessage);
+
+    jsonRpc.bindAsyncJson("subtract", [](const jsonrpc::JsonRequest& request,
+                                         jsonrpc::AsyncJsonResponse,
+                                         jsonrpc::ProgressUpdateCallback) {
+        BOOST_CHECK_EQUAL(request.params.size(), 2);
+        return [](jsonrpc::VoidCallback done) { done(); };
+    });
+    auto processResult = jsonRpc.processAsync(substractArray);
+    BOOST_CHECK(jsonRpc.processAsync(cancelSubstractArray).get().empty());
+    BOOST_CHECK_EQUAL(processResult.get(), cancelledRequestResult);
+}
@@ -57,6 +57,11 @@ struct MockServerCommunicator
         handleMessageAsync = callback;
     }
 
+    void handleBinary(ws::MessageCallbackAsync callback)
+    {
+        handleBinaryAsync = callback;
+    }
+
     void sendText(std::string, uintptr_t) {}
     void sendText(std::string message)
     {
@@ -70,7 +75,15 @@ struct MockServerCommunicator
         sendToRemoteEndpoint({message});
     }
 
+    std::set<uintptr_t> sendText(const std::string& message,
+                                 const std::set<uintptr_t>& clients)
+    {
+        sendToRemoteEndpoint({message});
+        return clients;
+    }
+
     ws::MessageCallbackAsync handleMessageAsync;
+    ws::MessageCallbackAsync handleBinaryAsync;
     ws::MessageCallback sendToRemoteEndpoint;
 };
 
@@ -94,13 +107,34 @@ struct MockClientCommunicator
         sendToRemoteEndpoint(message, handleResponse);
     }
 
+    void handleBinary(ws::MessageCallback callback)
+    {
+        handleBinaryMessage = std::move(callback);
+    }
+
+    void sendBinary(const char* data, const size_t size)
+    {
+        sentBinary.assign(data, size);
+        auto handleResponse = [this](std::string ret) {
+            if (!ret.empty())
+                handleBinaryMessage(std::move(ret));
+        };
+        remote->handleBinaryAsync({std::string(data, size), 0, protocol},
+                                  handleResponse);
+    }
+
     void connectWith(MockServerCommunicator& other)
     {
         sendToRemoteEndpoint = other.handleMessageAsync;
         other.sendToRemoteEndpoint = handleMessage;
+        remote = &other;
     }
 
     ws::MessageCallback handleMessage;
+    ws::MessageCallback handleBinaryMessage;
+    MockServerCommunicator* remote = nullptr;
+    std::string protocol;
+    std::string sentBinary;
     ws::MessageCallbackAsync sendToRemoteEndpoint;
     bool receivedMessage = false;
 };
@@ -251,6 +285,96 @@ BOOST_FIXTURE_TEST_CASE(client_notification_generates_no_response, Fixture)
     BOOST_CHECK(!clientCommunicator.receivedMessage);
 }
 
+BOOST_FIXTURE_TEST_CASE(client_request_answered_in_binary_encodings, Fixture)
+{
+    using json = rockets_nlohmann::json;
+
+    server.bind("test", [&](const jsonrpc::Request& request) {
+        return jsonrpc::Response{std::string(request.message)};
+    });
+    const auto params = json{{"values", {1.5, 2.5, 3.5}}};
+
+    server.setBinaryEncoding(jsonrpc::Encoding::msgpack);
+    client.setEncoding(jsonrpc::Encoding::msgpack);
+    auto request = client.request("test", params.dump());
+    BOOST_REQUIRE(request.is_ready());
+    BOOST_CHECK_EQUAL(json::parse(request.get().result), params);
+    auto sent = json::from_msgpack(clientCommunicator.sentBinary);
+    BOOST_CHECK_EQUAL(sent["params"], params);
+
+    server.setBinaryEncoding(jsonrpc::Encoding::cbor);
+    client.setEncoding(jsonrpc::Encoding::cbor);
+    request = client.request("test", params.dump());
+    BOOST_REQUIRE(request.is_ready());
+    BOOST_CHECK_EQUAL(json::parse(request.get().result), params);
+    sent = json::from_cbor(clientCommunicator.sentBinary);
+    BOOST_CHECK_EQUAL(sent["params"], params);
+
+    // text requests are still accepted
+    client.setEncoding(jsonrpc::Encoding::json);
+    request = client.request("test", params.dump());
+    BOOST_REQUIRE(request.is_ready());
+    BOOST_CHECK_EQUAL(json::parse(request.get().result), params);
+}
+
+BOOST_FIXTURE_TEST_CASE(binary_encoding_selected_by_websocket_protocol,
+                        Fixture)
+{
+    using json = rockets_nlohmann::json;
+
+    server.bind("test", [&](const jsonrpc::Request& request) {
+        return jsonrpc::Response{std::string(request.message)};
+    });
+    const auto params = json{{"values", {1.5, 2.5, 3.5}}};
+    server.setBinaryEncoding(jsonrpc::Encoding::msgpack);
+
+    clientCommunicator.protocol = "rockets.cbor";
+    client.setEncoding(jsonrpc::Encoding::cbor);
+    auto request = client.request("test", params.dump());
+    BOOST_REQUIRE(request.is_ready());
+    BOOST_CHECK_EQUAL(json::parse(request.get().result), params);
+
+    clientCommunicator.protocol = "rockets.msgpack";
+    client.setEncoding(jsonrpc::Encoding::msgpack);
+    request = client.request("test", params.dump());
+    BOOST_REQUIRE(request.is_ready());
+    BOOST_CHECK_EQUAL(json::parse(request.get().result), params);
+}
+
+BOOST_AUTO_TEST_CASE(clients_with_different_binary_encodings)
+{
+    Server wsServer("", "test,test.msgpack,test.cbor");
+    jsonrpc::Server<Server> server{wsServer};
+    server.setBinaryEncoding(jsonrpc::Encoding::msgpack);
+    server.bind<int, int>("double", [](const int value) { return 2 * value; });
+
+    ws::Client cborClient;
+    ws::Client msgpackClient;
+    jsonrpc::Client<ws::Client> client1{cborClient};
+    jsonrpc::Client<ws::Client> client2{msgpackClient};
+    client1.setEncoding(jsonrpc::Encoding::cbor);
+    client2.setEncoding(jsonrpc::Encoding::msgpack);
+
+    auto process = [&] {
+        cborClient.process(5);
+        msgpackClient.process(5);
+        wsServer.process(5);
+    };
+    auto connect1 = cborClient.connect(wsServer.getURI(), "test.cbor");
+    auto connect2 = msgpackClient.connect(wsServer.getURI(), "test.msgpack");
+    while (!is_ready(connect1) || !is_ready(connect2))
+        process();
+    BOOST_REQUIRE_NO_THROW(connect1.get());
+    BOOST_REQUIRE_NO_THROW(connect2.get());
+
+    auto request1 = client1.request<int, int>("double", 2);
+    auto request2 = client2.request<int, int>("double", 5);
+    while (!request1.is_ready() || !request2.is_ready())
+        process();
+    BOOST_CHECK_EQUAL(request1.get(), 4);
+    BOOST_CHECK_EQUAL(request2.get(), 10);
+}
+
 BOOST_FIXTURE_TEST_CASE(server_notification_received_by_client, Fixture)
 {
     bool received = false;
@@ -281,3 +405,47 @@ BOOST_FIXTURE_TEST_CASE(client_cancel_request, Fixture)
     BOOST_CHECK(request.is_ready());
     BOOST_CHECK_THROW(request.get(), std::runtime_error);
 }
+
+BOOST_FIXTURE_TEST_CASE(subscriber_receives_patches_of_exposed_object,
+                        Fixture)
+{
+    using json = rockets_nlohmann::json;
+
+    std::vector<int> object{1, 2};
+    server.expose("object", object);
+    BOOST_CHECK_THROW(server.expose("object", object), std::invalid_argument);
+    BOOST_CHECK(!server.publish("unknown"));
+
+    std::vector<json> patches;
+    client.connect("object.patch", [&](const jsonrpc::Request& request) {
+        patches.push_back(json::parse(request.message));
+    });
+
+    // changes before subscribing are part of the initial state
+    object.push_back(3);
+    BOOST_CHECK(server.publish("object"));
+
+    auto request = client.request("object.subscribe", "");
+    BOOST_REQUIRE(request.is_ready());
+    const auto response = request.get();
+    BOOST_REQUIRE(!response.isError());
+    auto state = json::parse(response.result);
+    BOOST_CHECK_EQUAL(state.dump(4), to_json(object));
+
+    object[0] = 42;
+    object.push_back(4);
+    BOOST_CHECK(server.publish("object"));
+    BOOST_REQUIRE_EQUAL(patches.size(), 1);
+    state = state.patch(patches[0]);
+    BOOST_CHECK_EQUAL(state.dump(4), to_json(object));
+
+    // no patch is sent if nothing changed
+    BOOST_CHECK(server.publish("object"));
+    BOOST_CHECK_EQUAL(patches.size(), 1);
+
+    BOOST_REQUIRE(client.request("object.unsubscribe", "").get().result ==
+                  "\"OK\"");
+    object.clear();
+    BOOST_CHECK(server.publish("object"));
+    BOOST_CHECK_EQUAL(patches.size(), 1);
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE rockets_perf_broadcast_latency
+
+#include <rockets/helpers.h>
+#include <rockets/server.h>
+#include <rockets/ws/client.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace rockets;
+using Clock = std::chrono::high_resolution_clock;
+using Microseconds = std::chrono::microseconds;
+
+namespace
+{
+const auto wsProtocol = "ws_perf_protocol";
+const size_t messageCount = 500;
+
+void connect(ws::Client& client, Server& server)
+{
+    auto future = client.connect(server.getURI(), wsProtocol);
+    while (!is_ready(future))
+        client.process(10);
+    future.get();
+}
+
+/** Measure the time between Server::broadcastText() and client reception. */
+std::vector<Microseconds::rep> measureLatency(const unsigned int threadCount)
+{
+    Server server{"", wsProtocol, threadCount};
+    ws::Client client;
+    std::atomic_bool received{false};
+    client.handleText([&](const ws::Request&) {
+        received = true;
+        return std::string();
+    });
+    connect(client, server);
+
+    std::vector<Microseconds::rep> latencies;
+    latencies.reserve(messageCount);
+    for (size_t i = 0; i < messageCount; ++i)
+    {
+        received = false;
+        const auto start = Clock::now();
+        server.broadcastText(std::to_string(i));
+        while (!received)
+            client.process(0);
+        const auto elapsed = Clock::now() - start;
+        latencies.push_back(
+            std::chrono::duration_cast<Microseconds>(elapsed).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+}
+
+BOOST_AUTO_TEST_CASE(broadcast_enqueue_to_wire_latency)
+{
+    for (const auto threadCount : {1u, 4u, 16u})
+    {
+        const auto latencies = measureLatency(threadCount);
+        const auto median = latencies[latencies.size() / 2];
+        const auto p99 = latencies[latencies.size() * 99 / 100];
+        std::cout << threadCount << " service thread(s): median " << median
+                  << " us, p99 " << p99 << " us, max " << latencies.back()
+                  << " us" << std::endl;
+    }
+}
@@ -0,0 +1,118 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE rockets_perf_connection_contention
+
+#include <rockets/helpers.h>
+#include <rockets/server.h>
+#include <rockets/ws/client.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace rockets;
+using namespace std::chrono_literals;
+
+namespace
+{
+const auto wsProtocol = "ws_perf_protocol";
+const auto duration = 2s;
+const auto broadcastInterval = 100us;
+
+void connect(ws::Client& client, Server& server)
+{
+    auto future = client.connect(server.getURI(), wsProtocol);
+    while (!is_ready(future))
+        client.process(10);
+    future.get();
+}
+
+/**
+ * Count the messages received by the server from clientCount clients, each
+ * sending as fast as it can, optionally while another thread broadcasts.
+ */
+size_t measureReceiveRate(const unsigned int threadCount,
+                          const size_t clientCount, const bool broadcast)
+{
+    Server server{"", wsProtocol, threadCount};
+    std::atomic<size_t> received{0};
+    server.handleText([&](const ws::Request&) {
+        ++received;
+        return std::string();
+    });
+
+    std::vector<std::unique_ptr<ws::Client>> clients;
+    for (size_t i = 0; i < clientCount; ++i)
+    {
+        clients.emplace_back(new ws::Client);
+        connect(*clients.back(), server);
+    }
+
+    std::atomic_bool running{true};
+    std::vector<std::thread> threads;
+    for (auto& client : clients)
+    {
+        threads.emplace_back([&running, &client] {
+            while (running)
+            {
+                client->sendText("ping");
+                client->process(0);
+            }
+        });
+    }
+    if (broadcast)
+    {
+        threads.emplace_back([&running, &server] {
+            while (running)
+            {
+                server.broadcastText("broadcast");
+                std::this_thread::sleep_for(broadcastInterval);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (auto& thread : threads)
+        thread.join();
+
+    return received / std::chrono::seconds(duration).count();
+}
+}
+
+BOOST_AUTO_TEST_CASE(receive_while_broadcasting)
+{
+    const size_t clientCount = 8;
+    for (const auto threadCount : {1u, 4u, 8u})
+    {
+        const auto idle = measureReceiveRate(threadCount, clientCount, false);
+        const auto busy = measureReceiveRate(threadCount, clientCount, true);
+        std::cout << threadCount << " service thread(s), " << clientCount
+                  << " clients: " << idle << " msg/s, " << busy
+                  << " msg/s while broadcasting" << std::endl;
+
+        BOOST_CHECK_GT(busy, 0);
+    }
+}
@@ -0,0 +1,99 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE rockets_perf_pending_requests
+
+#include <rockets/helpers.h>
+#include <rockets/http/client.h>
+#include <rockets/http/response.h>
+#include <rockets/server.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rockets;
+using namespace std::chrono_literals;
+
+namespace
+{
+const size_t pendingCount = 1000;
+const auto idleDuration = 1s;
+
+double getCpuSeconds()
+{
+    return double(std::clock()) / CLOCKS_PER_SEC;
+}
+}
+
+/**
+ * Measure the CPU time used by the server while 1000 requests are waiting for
+ * their asynchronous response. Pending connections are not polled, so the
+ * service thread should remain (almost) idle.
+ */
+BOOST_AUTO_TEST_CASE(cpu_usage_with_pending_requests)
+{
+    Server server{1u};
+    std::mutex mutex;
+    std::vector<http::Responder> responders;
+    server.handleAsync(http::Method::GET, "pending",
+                       [&](const http::Request&, http::Responder responder) {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           responders.push_back(std::move(responder));
+                       });
+
+    http::Client client;
+    std::vector<std::future<http::Response>> responses;
+    for (size_t i = 0; i < pendingCount; ++i)
+        responses.push_back(client.request(server.getURI() + "/pending"));
+
+    for (;;)
+    {
+        client.process(1);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (responders.size() == pendingCount)
+            break;
+    }
+
+    const auto start = getCpuSeconds();
+    std::this_thread::sleep_for(idleDuration);
+    const auto cpuTime = getCpuSeconds() - start;
+    const auto idleSeconds =
+        std::chrono::duration<double>(idleDuration).count();
+    std::cout << pendingCount << " pending requests: " << cpuTime
+              << " s CPU in " << idleSeconds << " s" << std::endl;
+    // polling the pending connections would keep the service thread busy for
+    // the whole idle duration
+    BOOST_CHECK_LT(cpuTime, 0.5 * idleSeconds);
+
+    for (const auto& responder : responders)
+        responder.respond(http::Response{http::Code::OK});
+    for (auto& response : responses)
+    {
+        while (!is_ready(response))
+            client.process(1);
+        BOOST_CHECK_EQUAL(int(response.get().code), int(http::Code::OK));
+    }
+}
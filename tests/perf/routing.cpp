@@ -0,0 +1,95 @@
+/* Copyright (c) 2018, EPFL/Blue Brain Project
+ *                     Raphael.Dumusc@epfl.ch
+ *
+ * This file is part of Rockets <https://github.com/BlueBrain/Rockets>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE rockets_perf_routing
+
+#include <rockets/helpers.h>
+#include <rockets/http/client.h>
+#include <rockets/server.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace rockets;
+using Clock = std::chrono::high_resolution_clock;
+using Microseconds = std::chrono::microseconds;
+
+namespace
+{
+const size_t requestCount = 500;
+
+const auto func = [](const http::Request& request) {
+    return http::Response{http::Code::OK, request.pathParams.at("z")};
+};
+
+std::string makeEndpoint(const size_t i)
+{
+    return "api/volumes" + std::to_string(i) + "/{id}/slices/{z:int}";
+}
+
+std::string makePath(const size_t i)
+{
+    return "/api/volumes" + std::to_string(i) + "/abc/slices/42";
+}
+
+/** @return the average time of a request to the given path. */
+double measureRequestTime(Server& server, const std::string& path)
+{
+    http::Client client;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < requestCount; ++i)
+    {
+        auto response = client.request(server.getURI() + path);
+        while (!is_ready(response))
+        {
+            client.process(0);
+            server.process(0);
+        }
+        BOOST_REQUIRE_EQUAL(response.get().body, "42");
+    }
+    const auto elapsed = Clock::now() - start;
+    return double(std::chrono::duration_cast<Microseconds>(elapsed).count()) /
+           requestCount;
+}
+}
+
+BOOST_AUTO_TEST_CASE(request_time_with_many_endpoints)
+{
+    double first = 0.0;
+    for (const size_t endpointCount : {10, 100, 1000, 10000})
+    {
+        Server server;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < endpointCount; ++i)
+            server.handle(http::Method::GET, makeEndpoint(i), func);
+        const auto registration = std::chrono::duration_cast<Microseconds>(
+            Clock::now() - start);
+
+        const auto path = makePath(endpointCount - 1);
+        const auto time = measureRequestTime(server, path);
+        if (endpointCount == 10)
+            first = time;
+        std::cout << endpointCount << " endpoints: registration "
+                  << registration.count() << " us, " << time
+                  << " us/request (x" << time / first << ")" << std::endl;
+    }
+}
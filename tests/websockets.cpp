@@ -23,12 +23,17 @@
 #include <rockets/server.h>
 #include <rockets/ws/client.h>
 
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 #include <boost/mpl/vector.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <libwebsockets.h>
+#if defined(LWS_WITH_LIBUV) || defined(LWS_USE_LIBUV)
+#include <uv.h>
+#endif
 
 #define CLIENT_SUPPORTS_INEXISTANT_PROTOCOL_ERRORS \
     (LWS_LIBRARY_VERSION_NUMBER >= 2000000)
@@ -118,6 +123,40 @@ BOOST_AUTO_TEST_CASE(client_connection_to_inexistant_protocol)
 }
 #endif
 
+BOOST_AUTO_TEST_CASE(server_accepts_a_list_of_protocols)
+{
+    Server server{"", "first, second"};
+    std::vector<std::string> protocols;
+    server.handleText([&](const ws::Request& request) {
+        protocols.push_back(request.protocol);
+        return "";
+    });
+
+    auto sendHello = [&](ws::Client& client, const std::string& protocol) {
+        auto future = client.connect(server.getURI(), protocol);
+        while (!is_ready(future))
+        {
+            client.process(10);
+            server.process(10);
+        }
+        BOOST_REQUIRE_NO_THROW(future.get());
+        client.sendText("hello");
+        while (protocols.size() < server.getConnectionCount())
+        {
+            client.process(10);
+            server.process(10);
+        }
+    };
+    ws::Client client1;
+    sendHello(client1, "first");
+    ws::Client client2;
+    sendHello(client2, "second");
+
+    BOOST_CHECK_EQUAL(protocols.size(), 2);
+    BOOST_CHECK_EQUAL(protocols[0], "first");
+    BOOST_CHECK_EQUAL(protocols[1], "second");
+}
+
 BOOST_AUTO_TEST_CASE(connect_to_localhost_with_proxy_and_no_proxy)
 {
     ScopedEnvironment no_proxy("no_proxy", "127.0.0.1");
@@ -293,6 +332,304 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(client_send_large_binary_message, F, Fixtures,
     BOOST_CHECK(F::receivedReply1);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(exchange_compressed_text_messages, F,
+                                 Fixtures, F)
+{
+    ws::CompressionOptions options;
+    options.windowBits = 10;
+    if (!F::server.setWebsocketCompression(options))
+        return; // libwebsockets built without extensions
+    BOOST_REQUIRE(F::client1.setCompression(options));
+
+    std::string json = "[";
+    for (int i = 0; i < 10000; ++i)
+        json += "{\"id\": " + std::to_string(i) + ", \"visible\": true},";
+    json.back() = ']';
+
+    F::server.handleText([&](const ws::Request& request) {
+        F::receivedMessage1 = (request.message == json);
+        return json;
+    });
+    F::client1.handleText([&](const ws::Request& request) {
+        F::receivedReply1 = (request.message == json);
+        return "";
+    });
+    std::atomic<uintptr_t> clientID{0};
+    F::server.handleOpen([&](const uintptr_t id) {
+        clientID = id;
+        return std::vector<ws::Response>();
+    });
+
+    connect(F::client1, F::server);
+    BOOST_REQUIRE_EQUAL(F::server.getConnectionCount(), 1);
+#if LWS_LIBRARY_VERSION_NUMBER >= 2000000
+    // permessage-deflate was negotiated on both ends of the connection
+    BOOST_CHECK(F::client1.isCompressed());
+    BOOST_CHECK(F::server.isCompressed(clientID));
+#endif
+
+    F::client1.sendText(json);
+    F::processClient1(F::server);
+
+    BOOST_CHECK(F::receivedMessage1);
+    BOOST_CHECK(F::receivedReply1);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_queue_drops_newest_messages)
+{
+    // without service threads, messages are only written during process()
+    Server server{"", wsProtocol};
+    ws::QueueOptions limits;
+    limits.maxMessages = 2;
+    limits.policy = ws::OverflowPolicy::dropNewest;
+    server.setWebsocketQueueLimits(limits);
+
+    uintptr_t clientID = 0;
+    server.handleOpen([&](const uintptr_t id) {
+        clientID = id;
+        return std::vector<ws::Response>();
+    });
+    ws::Client client;
+    std::vector<std::string> received;
+    client.handleText([&](const ws::Request& request) {
+        received.push_back(request.message);
+        return "";
+    });
+    connect(client, server);
+
+    for (int i = 0; i < 5; ++i)
+        server.broadcastText(std::to_string(i));
+    auto stats = server.getQueueStats(clientID);
+    BOOST_CHECK_EQUAL(stats.messages, 2);
+    BOOST_CHECK_EQUAL(stats.bytes, 2);
+    BOOST_CHECK_EQUAL(stats.dropped, 3);
+
+    while (received.size() < 2)
+    {
+        server.process(10);
+        client.process(10);
+    }
+    BOOST_CHECK_EQUAL(received[0], "0");
+    BOOST_CHECK_EQUAL(received[1], "1");
+    stats = server.getQueueStats(clientID);
+    BOOST_CHECK_EQUAL(stats.messages, 0);
+    BOOST_CHECK_EQUAL(stats.bytes, 0);
+    BOOST_CHECK_EQUAL(stats.sent, 2);
+}
+
+BOOST_AUTO_TEST_CASE(conflated_broadcast_sends_latest_value)
+{
+    Server server{"", wsProtocol};
+    uintptr_t clientID = 0;
+    server.handleOpen([&](const uintptr_t id) {
+        clientID = id;
+        return std::vector<ws::Response>();
+    });
+    ws::Client client;
+    std::vector<std::string> received;
+    client.handleText([&](const ws::Request& request) {
+        received.push_back(request.message);
+        return "";
+    });
+    connect(client, server);
+
+    for (int i = 0; i < 5; ++i)
+        server.broadcastConflatedText("camera", "camera " + std::to_string(i));
+    server.broadcastConflatedText("progress", "progress");
+    server.broadcastConflatedText("camera", "camera 5");
+    const auto stats = server.getQueueStats(clientID);
+    BOOST_CHECK_EQUAL(stats.messages, 2);
+    BOOST_CHECK_EQUAL(stats.dropped, 5);
+
+    while (received.size() < 2)
+    {
+        server.process(10);
+        client.process(10);
+    }
+    BOOST_CHECK_EQUAL(received[0], "camera 5");
+    BOOST_CHECK_EQUAL(received[1], "progress");
+}
+
+BOOST_AUTO_TEST_CASE(conflated_broadcast_respects_queue_limits)
+{
+    Server server{"", wsProtocol};
+    ws::QueueOptions limits;
+    limits.maxBytes = 10;
+    server.setWebsocketQueueLimits(limits);
+    uintptr_t clientID = 0;
+    server.handleOpen([&](const uintptr_t id) {
+        clientID = id;
+        return std::vector<ws::Response>();
+    });
+    ws::Client client;
+    std::vector<std::string> received;
+    client.handleText([&](const ws::Request& request) {
+        received.push_back(request.message);
+        return "";
+    });
+    connect(client, server);
+
+    // the larger value replacing the first message drops the older second one
+    server.broadcastConflatedText("camera", "c0");
+    server.broadcastText("12345");
+    server.broadcastConflatedText("camera", "camera 123");
+    const auto stats = server.getQueueStats(clientID);
+    BOOST_CHECK_EQUAL(stats.messages, 1);
+    BOOST_CHECK_EQUAL(stats.bytes, 10);
+    BOOST_CHECK_EQUAL(stats.dropped, 2);
+
+    while (received.empty())
+    {
+        server.process(10);
+        client.process(10);
+    }
+    BOOST_CHECK_EQUAL(received[0], "camera 123");
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_conflated_broadcasts_queue_one_message_per_key)
+{
+    Server server{"", wsProtocol, 1u};
+    std::atomic<uintptr_t> clientID{0};
+    server.handleOpen([&](const uintptr_t id) {
+        clientID = id;
+        return std::vector<ws::Response>();
+    });
+    ws::Client client;
+    connect(client, server);
+    while (clientID == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&server] {
+            for (int i = 0; i < 1000; ++i)
+                server.broadcastConflatedText("camera", std::to_string(i));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    BOOST_CHECK_LE(server.getQueueStats(clientID).messages, 1);
+}
+
+BOOST_AUTO_TEST_CASE(server_disconnects_client_sending_too_big_message)
+{
+    Server server{"", wsProtocol};
+    server.setWebsocketMaxMessageSize(10);
+    std::vector<std::string> received;
+    server.handleText([&](const ws::Request& request) {
+        received.push_back(request.message);
+        return "";
+    });
+    ws::Client client;
+    connect(client, server);
+    BOOST_REQUIRE_EQUAL(server.getConnectionCount(), 1);
+
+    client.sendText("0123456789");
+    while (received.empty())
+    {
+        client.process(10);
+        server.process(10);
+    }
+    BOOST_CHECK_EQUAL(received[0], "0123456789");
+
+    client.sendText("message too big");
+    while (server.getConnectionCount() > 0)
+    {
+        client.process(10);
+        server.process(10);
+    }
+    BOOST_CHECK_EQUAL(received.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(publish_text_to_topic_subscribers)
+{
+    Server server{"", wsProtocol};
+    std::vector<uintptr_t> clientIDs;
+    server.handleOpen([&](const uintptr_t id) {
+        clientIDs.push_back(id);
+        return std::vector<ws::Response>();
+    });
+    ws::Client subscriber;
+    ws::Client other;
+    std::vector<std::string> received;
+    bool otherReceived = false;
+    subscriber.handleText([&](const ws::Request& request) {
+        received.push_back(request.message);
+        return "";
+    });
+    other.handleText([&](const ws::Request&) {
+        otherReceived = true;
+        return "";
+    });
+    connect(subscriber, server);
+    connect(other, server);
+    BOOST_REQUIRE_EQUAL(clientIDs.size(), 2);
+
+    BOOST_CHECK(server.subscribe(clientIDs[0], "camera"));
+    BOOST_CHECK(!server.subscribe(clientIDs[0], "camera"));
+    BOOST_CHECK(!server.subscribe(0, "camera"));
+    BOOST_CHECK_EQUAL(server.getSubscriberCount("camera"), 1);
+
+    server.publishText("progress", "nobody listens");
+    server.publishText("camera", "camera 0");
+    while (received.empty())
+    {
+        server.process(10);
+        subscriber.process(10);
+        other.process(10);
+    }
+    BOOST_CHECK_EQUAL(received[0], "camera 0");
+    BOOST_CHECK(!otherReceived);
+
+    BOOST_CHECK(server.unsubscribe(clientIDs[0], "camera"));
+    BOOST_CHECK(!server.unsubscribe(clientIDs[0], "camera"));
+    BOOST_CHECK_EQUAL(server.getSubscriberCount("camera"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_queue_disconnects_slow_client)
+{
+    Server server{"", wsProtocol};
+    ws::QueueOptions limits;
+    limits.maxBytes = 10;
+    limits.policy = ws::OverflowPolicy::disconnect;
+    server.setWebsocketQueueLimits(limits);
+
+    ws::Client client;
+    connect(client, server);
+    BOOST_REQUIRE_EQUAL(server.getConnectionCount(), 1);
+
+    server.broadcastText("0123456789");
+    server.broadcastText("overflow");
+    while (server.getConnectionCount() > 0)
+    {
+        server.process(10);
+        client.process(10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bounded_queue_disconnects_stalled_client)
+{
+    Server server{"", wsProtocol};
+    ws::QueueOptions limits;
+    limits.maxMessages = 4;
+    limits.policy = ws::OverflowPolicy::disconnect;
+    server.setWebsocketQueueLimits(limits);
+
+    ws::Client client;
+    connect(client, server);
+    BOOST_REQUIRE_EQUAL(server.getConnectionCount(), 1);
+
+    // the client never reads, so its socket stops being writable
+    const std::string message(1024 * 1024, 'a');
+    for (int i = 0; i < 1000 && server.getConnectionCount() > 0; ++i)
+    {
+        server.broadcastText(message);
+        server.process(10);
+    }
+    BOOST_CHECK_EQUAL(server.getConnectionCount(), 0);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(server_broadcast_text_message, F, Fixtures, F)
 {
     F::client1.handleText([&](const ws::Request& request) {
@@ -513,6 +850,44 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(server_monitor_connections, F, Fixtures, F)
     BOOST_CHECK_EQUAL(numConnections, 0);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(server_send_text_to_closed_client_is_dropped,
+                                 F, Fixtures, F)
+{
+    std::vector<uintptr_t> clientIDs;
+    F::server.handleOpen([&](const uintptr_t clientID) {
+        clientIDs.push_back(clientID);
+        F::receivedConnect = true;
+        F::receivedConnectReply = true;
+        return std::vector<ws::Response>{};
+    });
+    F::server.handleClose([&](const uintptr_t) {
+        F::receivedDisconnect = true;
+        return std::vector<ws::Response>{};
+    });
+    F::client1.handleText([&](const ws::Request& request) {
+        BOOST_REQUIRE(request.message == "hello client1");
+        F::receivedMessage1 = true;
+        return "";
+    });
+
+    connect(*F::client3, F::server);
+    F::processClient3Connect(F::server);
+    F::client3.reset();
+    F::processClient3Disconnect(F::server);
+
+    // the new connection may reuse the slot of the closed one, not its ID
+    connect(F::client1, F::server);
+    BOOST_REQUIRE_EQUAL(F::server.getConnectionCount(), 1);
+    BOOST_REQUIRE_EQUAL(clientIDs.size(), 2);
+    BOOST_CHECK_NE(clientIDs[0], clientIDs[1]);
+
+    F::server.sendText("hello client3", clientIDs[0]);
+    F::server.sendText("hello client1", clientIDs[1]);
+    F::receivedReply1 = true;
+    F::processClient1(F::server);
+    BOOST_CHECK(F::receivedMessage1);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(server_unspecified_format_response, F,
                                  Fixtures, F)
 {
@@ -567,3 +942,53 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(text_binary_exchange_with_unhandled_text, F,
     F::server.broadcastBinary("hello", 5);
     F::processAllClients(F::server);
 }
+
+#if defined(LWS_WITH_LIBUV) || defined(LWS_USE_LIBUV)
+BOOST_AUTO_TEST_CASE(async_reply_on_uv_loop)
+{
+    uv_loop_t loop;
+    uv_loop_init(&loop);
+    // the server requires a running loop, i.e. one with an active handle
+    uv_timer_t timer;
+    uv_timer_init(&loop, &timer);
+    uv_timer_start(&timer, [](uv_timer_t*) {}, 0, 10);
+
+    std::thread replyThread;
+    std::atomic<bool> receivedReply{false};
+    {
+        Server server{&loop, "", wsProtocol};
+        server.handleText([&](ws::Request, ws::ResponseCallback callback) {
+            // reply from another thread, the loop must be woken up
+            replyThread = std::thread([callback] { callback("server"); });
+        });
+        ws::Client client;
+        client.handleText([&](const ws::Request& request) {
+            receivedReply = (request.message == "server");
+            return "";
+        });
+
+        auto future = client.connect(server.getURI(), wsProtocol);
+        while (!is_ready(future))
+        {
+            client.process(10);
+            uv_run(&loop, UV_RUN_NOWAIT);
+        }
+        BOOST_REQUIRE_NO_THROW(future.get());
+
+        client.sendText("hello");
+        int maxServiceLoops = 200;
+        while (!receivedReply && --maxServiceLoops)
+        {
+            client.process(10);
+            uv_run(&loop, UV_RUN_NOWAIT);
+        }
+        if (replyThread.joinable())
+            replyThread.join();
+    }
+    BOOST_CHECK(receivedReply);
+
+    uv_close(reinterpret_cast<uv_handle_t*>(&timer), nullptr);
+    uv_run(&loop, UV_RUN_DEFAULT);
+    uv_loop_close(&loop);
+}
+#endif